@@ -0,0 +1,89 @@
+#ifndef ASYNC_IO_H_
+#define ASYNC_IO_H_
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "const.h"
+
+#if defined(__linux__) && defined(__has_include) && !defined(GSQL_NO_IO_URING)
+#if __has_include(<linux/io_uring.h>)
+#define GSQL_IO_URING
+#endif
+#endif
+
+constexpr size_t kIoRingSize = 64;
+constexpr size_t kIoThreadCount = 4;
+
+struct IoRequest
+{
+  Page *page;
+  int fd;
+  size_t offset;
+  size_t size;
+  long result;
+};
+
+// Page reads that finish in the background. An io_uring is set up on first
+// use; if the kernel refuses it, kIoThreadCount threads issue pread instead.
+// Workers only fill frame buffers. Completions are handed back to the caller's
+// thread through reap() and wait(), so Page bookkeeping stays single threaded.
+class AsyncIo
+{
+public:
+  AsyncIo() = default;
+  AsyncIo(const AsyncIo &) = delete;
+  AsyncIo &operator=(const AsyncIo &) = delete;
+  ~AsyncIo();
+  void submit(Page *page, int fd, size_t offset, size_t size);
+  bool wait(Page *page);
+  std::vector<std::pair<Page *, bool>> reap();
+  std::vector<std::pair<Page *, bool>> drain();
+  size_t inFlight() const
+  {
+    return pending_map_.size();
+  }
+
+private:
+  void start();
+  void collect(bool block);
+  void work();
+#ifdef GSQL_IO_URING
+  bool setupRing();
+  void submitRing(const IoRequest &request);
+  void collectRing(bool block);
+#endif
+
+  bool started_ = false;
+  std::unordered_map<Page *, size_t> pending_map_;
+  std::unordered_map<Page *, bool> completed_map_;
+
+  std::vector<std::thread> worker_vector_;
+  std::mutex mutex_;
+  std::condition_variable request_cv_;
+  std::condition_variable done_cv_;
+  std::deque<IoRequest> request_deque_;
+  std::vector<IoRequest> done_vector_;
+  bool stop_ = false;
+
+  int ring_fd_ = -1;
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  void *sqe_array_ = nullptr;
+  size_t sqe_array_size_ = 0;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  void *cqe_array_ = nullptr;
+};
+
+#endif
\ No newline at end of file
@@ -3,38 +3,160 @@
 
 #include <cstddef>
 #include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
 #include "const.h"
 #include "buffer_pool.h"
 
 size_t createNewPage(const PageSchema &page_schema);
 
-size_t BPlusTreeInsert(size_t page_id, char *key, char *value, bool unique, size_t *root_page_id);
+size_t BPlusTreeInsert(size_t page_id, char *key, char *value, bool unique, size_t *root_page_id, size_t value_size = 0);
 
 void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id);
 
-char *BPlusTreeSearch(size_t page_id, char *key, bool is_index);
+// A record in a leaf with a key prefix is rebuilt in buffer, since the page
+// only holds the rest of its key. A record of a slotted leaf points into the
+// row heap of its page.
+struct RecordPtr
+{
+    PagePtr page_ptr;
+    char *record;
+    std::shared_ptr<std::vector<char>> buffer;
+    RecordPtr(PagePtr ptr = PagePtr(), char *rec = nullptr) : page_ptr(std::move(ptr)), record(rec) {}
+    operator char *() const
+    {
+        return record;
+    }
+};
+
+RecordPtr makeRecordPtr(Page *page, const PageHeader &page_schema, char *entry);
+
+RecordPtr BPlusTreeSearch(size_t page_id, char *key, bool is_index);
+
+bool BPlusTreeUpdate(size_t page_id, char *key, const char *value);
+
+constexpr size_t kHintRightHops = 1;
+
+RecordPtr BPlusTreeHintSearch(size_t page_id, size_t tree_id, char *key);
+
+std::vector<RecordPtr> BPlusTreeMultiSearch(size_t page_id, const std::vector<char *> &key_vector, bool is_index, const std::vector<size_t> *hint_vector = nullptr);
+
+void multiSearchPage(size_t page_id, const std::vector<char *> &key_vector, const std::vector<size_t> &order_vector, size_t begin, size_t end, bool is_index, std::vector<RecordPtr> *record_vector);
 
 void BPlusTreeRemove(size_t page_id);
 
-size_t insertNonFullPage(size_t page_id, char *key, char *value, bool unique);
+size_t BPlusTreeTruncate(size_t page_id);
+
+void BPlusTreeDeleteRange(size_t page_id, char *begin_key, char *end_key, bool is_index, size_t *root_page_id_ptr);
 
-bool pageIsFull(const PageSchema &page_schema);
+size_t deleteRangeFromPage(size_t page_id, size_t level, char *begin_key, char *end_key, bool is_index, size_t *first_leaf_page_id_ptr, size_t *last_leaf_page_id_ptr, std::pair<size_t, size_t> *left_pair_ptr);
+
+void removeSubTree(size_t page_id, size_t level, size_t *first_leaf_page_id_ptr, size_t *last_leaf_page_id_ptr);
+
+size_t getTreeLevel(size_t page_id);
+
+void BPlusTreeLeafRun(size_t page_id, size_t level, char *key, size_t count, std::vector<size_t> *leaf_vector);
+
+size_t BPlusTreeResidentCount(size_t page_id);
+
+size_t insertNonFullPage(size_t page_id, char *key, char *value, bool unique, size_t value_size);
+
+size_t upperBoundInPage(const PageHeader &page_schema, size_t pos, const char *key, size_t compare_size);
+
+size_t lowerBoundInPage(const PageHeader &page_schema, size_t pos, const char *key, size_t compare_size);
+
+bool pageIsFull(const PageSchema &page_schema, const char *key, size_t value_size);
 
 bool pageIsMinimum(const PageSchema &page_schema);
 
-PageSchema getPageSchema(size_t page_id);
+Page *getPageHandle(size_t page_id, bool scan = false);
+
+void decodePageHeader(Page *page);
+
+PageSchema getPageSchema(size_t page_id, bool scan = false);
+
+size_t splitFullPage(size_t page_id, char *middle_key, const char *key, size_t value_size);
+
+size_t slottedMiddle(const PageSchema &page_schema, const char *key, size_t value_size);
 
-size_t splitFullPage(size_t page_id, char *middle_key);
+bool pageIsCompressible(const PageHeader &page_schema);
+
+const char *pagePrefix(const PageHeader &page_schema);
+
+void copyKey(const PageHeader &page_schema, const char *entry, char *key);
+
+void copyEntry(const PageHeader &page_schema, const char *entry, char *record);
+
+int compareEntry(const PageHeader &page_schema, const char *key, const char *entry, size_t compare_size);
+
+size_t prefixWith(const PageHeader &page_schema, const char *key);
+
+void setPagePrefix(PageSchema &page_schema, const char *prefix, size_t prefix_size);
+
+void compactPrefix(PageSchema &page_schema);
+
+bool pageIsSlotted(const PageHeader &page_schema);
+
+char *slotRecord(const PageHeader &page_schema, const char *entry);
+
+size_t slotSize(const PageHeader &page_schema, const char *entry);
+
+void setHeapSize(PageSchema &page_schema, size_t heap_size);
+
+void appendRecord(PageSchema &page_schema, char *entry, const char *value, size_t value_size);
+
+void removeRecord(PageSchema &page_schema, const char *entry);
+
+void compactHeap(PageSchema &page_schema);
+
+void transferEntry(const PageHeader &page_schema, const char *entry, PageSchema &new_page_schema, char *new_entry);
+
+size_t writeOverflow(const char *data, size_t size);
+
+void readOverflow(size_t page_id, size_t size, char *data);
+
+void freeOverflow(size_t page_id);
 
 bool dataOverFlow(size_t key_size,size_t value_size);
 
+// An Iter built with its tree's root reads ahead while it walks the leaf
+// chain: the leaves that follow the current one under the same parent are
+// handed to BufferPool::readAhead, kReadAheadSize at a time.
 class Iter : public std::iterator<std::random_access_iterator_tag, char *>
 {
     PageSchema page_schema_;
     size_t pos_;
+    size_t root_page_id_ = -1;
+    size_t level_ = -1;
+    std::vector<size_t> read_ahead_vector_;
+    size_t read_ahead_pos_ = 0;
+    std::vector<char> record_buffer_;
+
+    void readAhead()
+    {
+        if (root_page_id_ == -1 || page_schema_.right_page_id == -1)
+            return;
+        while (read_ahead_pos_ < read_ahead_vector_.size() && read_ahead_vector_[read_ahead_pos_] != page_schema_.page_id)
+            ++read_ahead_pos_;
+        size_t remain = read_ahead_pos_ < read_ahead_vector_.size() ? read_ahead_vector_.size() - read_ahead_pos_ - 1 : 0;
+        if (remain >= kReadAheadSize / 2)
+            return;
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        if (remain == 0 && buffer_pool.peekPage(page_schema_.right_page_id))
+            return;
+        if (level_ == -1)
+            level_ = getTreeLevel(root_page_id_);
+        read_ahead_vector_.clear();
+        read_ahead_pos_ = 0;
+        std::vector<char> key(page_schema_.key_size + page_schema_.prefix_size);
+        copyKey(page_schema_, page_schema_.page_buffer + kOffsetOfPageHeader, key.data());
+        BPlusTreeLeafRun(root_page_id_, level_, key.data(), kReadAheadSize + 1, &read_ahead_vector_);
+        buffer_pool.readAhead(read_ahead_vector_);
+    }
 
 public:
-    Iter(std::pair<size_t, size_t> pair)
+    Iter(std::pair<size_t, size_t> pair, size_t root_page_id = -1) : root_page_id_(root_page_id)
     {
         setPage(pair);
     }
@@ -42,13 +164,13 @@ public:
     {
         setPage({page_id, kOffsetOfPageHeader});
     }
-    Iter &setPage(std::pair<size_t, size_t> pair)
+    Iter &setPage(std::pair<size_t, size_t> pair, bool scan = false)
     {
         if (pair.first == -1)
             page_schema_.page_id = -1;
         else
         {
-            page_schema_ = getPageSchema(pair.first);
+            page_schema_ = getPageSchema(pair.first, scan);
             pos_ = pair.second;
         }
         return *this;
@@ -64,7 +186,9 @@ public:
             pos_ += page_schema_.key_size + page_schema_.value_size;
             if (pos_ >= page_schema_.total_size)
             {
-                setPage({page_schema_.right_page_id, kOffsetOfPageHeader});
+                setPage({page_schema_.right_page_id, kOffsetOfPageHeader}, true);
+                if (page_schema_.page_id != -1)
+                    readAhead();
             }
         }
         return *this;
@@ -73,7 +197,15 @@ public:
     {
         if (page_schema_.page_id != -1)
         {
-            if (pos_ < page_schema_.total_size)
+            if (pos_ < page_schema_.total_size && pageIsSlotted(page_schema_))
+                return slotRecord(page_schema_, page_schema_.page_buffer + pos_);
+            else if (pos_ < page_schema_.total_size && page_schema_.prefix_size)
+            {
+                record_buffer_.resize(page_schema_.prefix_size + page_schema_.key_size + page_schema_.value_size);
+                copyEntry(page_schema_, page_schema_.page_buffer + pos_, record_buffer_.data());
+                return record_buffer_.data();
+            }
+            else if (pos_ < page_schema_.total_size)
                 return page_schema_.page_buffer + pos_;
             else
                 return nullptr;
@@ -101,18 +233,19 @@ class Iterator
 public:
     Iter begin()
     {
-        return Iter(begin_pair_);
+        return Iter(begin_pair_, root_page_id_);
     }
     Iter end()
     {
         return Iter(end_pair_);
     }
 
-    Iterator(std::pair<size_t, size_t> begin_pair, std::pair<size_t, size_t> end_pair) : begin_pair_(begin_pair), end_pair_(end_pair){}
+    Iterator(std::pair<size_t, size_t> begin_pair, std::pair<size_t, size_t> end_pair, size_t root_page_id = -1) : begin_pair_(begin_pair), end_pair_(end_pair), root_page_id_(root_page_id) {}
 
 private:
     std::pair<size_t, size_t> begin_pair_;
     std::pair<size_t, size_t> end_pair_;
+    size_t root_page_id_;
 };
 
 size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is_index, size_t *pos_ptr);
@@ -1,33 +1,172 @@
 #ifndef BUFFER_POOL_H_
 #define BUFFER_POOL_H_
 #include <cstddef>
-#include <memory>
 #include <list>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "file_system.h"
 
+constexpr size_t kFrameAlignment = 4096;
+constexpr size_t kReadAheadSize = 8;
+
+class PageList
+{
+public:
+  void pushFront(Page *page)
+  {
+    page->prev = nullptr;
+    page->next = head_;
+    if (head_)
+      head_->prev = page;
+    else
+      tail_ = page;
+    head_ = page;
+    ++size_;
+  }
+  void remove(Page *page)
+  {
+    if (page->prev)
+      page->prev->next = page->next;
+    else
+      head_ = page->next;
+    if (page->next)
+      page->next->prev = page->prev;
+    else
+      tail_ = page->prev;
+    page->prev = page->next = nullptr;
+    --size_;
+  }
+  Page *back() const
+  {
+    return tail_;
+  }
+  size_t size() const
+  {
+    return size_;
+  }
+
+private:
+  Page *head_ = nullptr;
+  Page *tail_ = nullptr;
+  size_t size_ = 0;
+};
+
+using PageKey = std::pair<size_t, size_t>;
+
+struct MyPageKeyHashFunction
+{
+  size_t operator()(const PageKey &page_key) const
+  {
+    return std::hash<size_t>()(page_key.first * 0x9e3779b97f4a7c15 ^ page_key.second);
+  }
+};
+
+struct Extent
+{
+  char *arena;
+  std::vector<Page> frame_vector;
+};
+
+// Frames are carved out of aligned extents of kExtentSize frames; resize()
+// adds extents or hands back trailing ones once none of their frames is
+// pinned. A PagePtr pins its frame, and a pinned frame is never evicted.
+// Frames are as large as the largest page size of the databases used so far,
+// so the pool takes capacity() times that; reserveFrameSize() drops every
+// cached page and reallocates the frames when a database with larger pages
+// is used.
+// Replacement is 2Q: a page seen once waits in the A1in fifo and only reaches
+// the Am lru if it is asked for again after falling out of A1in (A1out keeps
+// those page ids). Sequential leaf walks go through a small scan ring so a
+// large scan or a temporary result tree can't flush hot index pages.
+// readAhead() starts asynchronous reads of up to kReadAheadSize pages into
+// the scan ring; a lookup that lands on one of them waits for its read.
 class BufferPool
 {
 public:
   BufferPool(const BufferPool &) = delete;
   BufferPool &operator=(BufferPool) = delete;
   BufferPool(BufferPool &&) noexcept = delete;
-  ~BufferPool() {}
+  ~BufferPool();
   static BufferPool &getInstance();
-  PagePtr getPage(size_t page_id);
-  void clear()
+  PagePtr getPage(size_t page_id, bool scan = false)
+  {
+    return PagePtr(fetchPage(page_id, scan));
+  }
+  Page *fetchPage(size_t page_id, bool scan = false);
+  Page *peekPage(size_t page_id)
+  {
+    auto iter = id_page_map_.find({file_system_.getFileId(), page_id});
+    return iter == id_page_map_.end() ? nullptr : iter->second;
+  }
+  void adviseWillNeed(size_t page_id)
+  {
+    if (page_id != -1 && !peekPage(page_id))
+      file_system_.adviseWillNeed(page_id, 1);
+  }
+  void clear(size_t file_id);
+  std::vector<size_t> getResidentPages(size_t file_id);
+  size_t prefetch(std::vector<size_t> page_id_vector);
+  size_t readAhead(const std::vector<size_t> &page_id_vector);
+  size_t resize(size_t size);
+  void reserveFrameSize(size_t page_size);
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+  size_t size() const
+  {
+    return a1in_list_.size() + am_list_.size() + scan_list_.size();
+  }
+  size_t pinnedCount() const;
+  size_t hitCount() const
+  {
+    return hit_count_;
+  }
+  size_t missCount() const
+  {
+    return miss_count_;
+  }
+  size_t evictionCount() const
+  {
+    return eviction_count_;
+  }
+  size_t readAheadCount() const
   {
-    page_ptr_list_.clear();
-    id_page_map_.clear();
+    return read_ahead_count_;
   }
 
 private:
-  BufferPool() : file_system_(FileSystem::getInstance()) {}
+  BufferPool();
+  void addExtent();
+  bool removeExtent();
+  Page *getFreeFrame(bool scan);
+  Page *evict(PageList &page_list);
+  void releaseFrame(Page *page);
+  void pushA1out(const PageKey &page_key);
+  PageList &getList(PageQueue queue);
 
   FileSystem &file_system_;
-  std::list<PagePtr> page_ptr_list_;
-  std::unordered_map<int, std::list<PagePtr>::iterator> id_page_map_;
-  size_t kMaxSize = 2000;
+  std::vector<Extent> extent_vector_;
+  PageList free_list_;
+  PageList a1in_list_;
+  PageList am_list_;
+  PageList scan_list_;
+  std::list<PageKey> a1out_list_;
+  std::unordered_map<PageKey, std::list<PageKey>::iterator, MyPageKeyHashFunction> a1out_map_;
+  std::unordered_map<PageKey, Page *, MyPageKeyHashFunction> id_page_map_;
+  size_t capacity_ = 0;
+  size_t frame_size_ = kMinPageSize;
+  size_t a1in_size_ = 0;
+  size_t a1out_size_ = 0;
+  size_t hit_count_ = 0;
+  size_t miss_count_ = 0;
+  size_t eviction_count_ = 0;
+  size_t read_ahead_count_ = 0;
+  const size_t kDefaultSize = 2000;
+  const size_t kMinSize = 32;
+  const size_t kExtentSize = 16;
+  const size_t kScanRingSize = 16;
 };
 
 #endif
\ No newline at end of file
@@ -2,34 +2,107 @@
 #define CONST_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <utility>
 
-constexpr size_t kPageSize = 16000;
+constexpr size_t kDefaultPageSize = 16384;
+constexpr size_t kMinPageSize = 4096;
+constexpr size_t kMaxPageSize = 65536;
 constexpr size_t kSizeOfSizeT = sizeof(size_t);
 constexpr size_t kSizeOfInt = sizeof(int);
 constexpr size_t kSizeOfBool = sizeof(bool);
 constexpr size_t kSizeOfLong = sizeof(long);
 constexpr size_t kSizeOfChar = sizeof(char);
+constexpr size_t kSizeOfSlot = 2 * sizeof(uint32_t);
 
-constexpr size_t kOffsetOfLeaf = 0;
-constexpr size_t kOffsetOfSize = sizeof(bool);
-constexpr size_t kOffsetOfLeftPageId = kOffsetOfSize + sizeof(size_t);
-constexpr size_t kOffsetOfRightPageId = kOffsetOfLeftPageId + sizeof(size_t);
-constexpr size_t kOffsetOfKeySize = kOffsetOfRightPageId + sizeof(size_t);
-constexpr size_t kOffsetOfIndexSize = kOffsetOfKeySize + sizeof(size_t);
-constexpr size_t kOffsetOfValueSize = kOffsetOfIndexSize + sizeof(size_t);
-constexpr size_t kOffsetOfCompareType = kOffsetOfValueSize + sizeof(size_t);
-constexpr size_t kOffsetOfPageHeader = kOffsetOfCompareType + sizeof(bool);
+constexpr size_t kSizeOfVarcharLength = sizeof(uint16_t);
+constexpr size_t kSizeOfDictionaryCode = sizeof(uint16_t);
+constexpr size_t kMaxDictionarySize = UINT16_MAX + 1;
 
-struct Page
+// A zone value holds the key its zone begins at, its row count and, for each
+// ZONEMAP column, the least and the greatest value in the zone.
+constexpr size_t kOffsetOfZoneCount = kSizeOfBool + kSizeOfSizeT;
+constexpr size_t kOffsetOfZoneRange = kOffsetOfZoneCount + kSizeOfSizeT;
+
+// A VARCHAR value too long to stay in its row is kept in a chain of
+// overflow pages, and in its place an overflow pointer holds the first
+// kSizeOfOverflowPrefix bytes, the length and the first page of the chain.
+// A row marks the pointer with kOverflowLength for its length. A result row
+// marks it with kOverflowFlag for its null flag when the result owns the
+// chain, and with kOverflowReferenceFlag when it points at a table's chain.
+constexpr size_t kSizeOfOverflowPrefix = 32;
+constexpr size_t kSizeOfOverflowPointer = kSizeOfOverflowPrefix + 2 * sizeof(size_t);
+constexpr uint16_t kOverflowLength = 0xffff;
+constexpr char kOverflowFlag = 2;
+constexpr char kOverflowReferenceFlag = 3;
+
+// The page header keeps page ids, the entry count, the tree id and the heap
+// size in 32 bits and the key, index, value and prefix sizes in 16, which
+// hold anything a page of kMaxPageSize can. The 32 bit fields come first,
+// then the 16 bit ones and the leaf flag, and entries start eight byte
+// aligned behind them.
+constexpr size_t kOffsetOfSize = 0;
+constexpr size_t kOffsetOfLeftPageId = kOffsetOfSize + sizeof(uint32_t);
+constexpr size_t kOffsetOfRightPageId = kOffsetOfLeftPageId + sizeof(uint32_t);
+constexpr size_t kOffsetOfTreeId = kOffsetOfRightPageId + sizeof(uint32_t);
+constexpr size_t kOffsetOfHeapSize = kOffsetOfTreeId + sizeof(uint32_t);
+constexpr size_t kOffsetOfKeySize = kOffsetOfHeapSize + sizeof(uint32_t);
+constexpr size_t kOffsetOfIndexSize = kOffsetOfKeySize + sizeof(uint16_t);
+constexpr size_t kOffsetOfValueSize = kOffsetOfIndexSize + sizeof(uint16_t);
+constexpr size_t kOffsetOfPrefixSize = kOffsetOfValueSize + sizeof(uint16_t);
+constexpr size_t kOffsetOfLeaf = kOffsetOfPrefixSize + sizeof(uint16_t);
+constexpr size_t kOffsetOfPageHeader = (kOffsetOfLeaf + sizeof(bool) + 7) / 8 * 8;
+
+// Only the copy of a page on disk uses this byte, to mark it compressed.
+constexpr size_t kOffsetOfPageCodec = kOffsetOfLeaf + sizeof(bool);
+constexpr char kPageCodecLz = 1;
+
+// Writes value to the header field at offset in the width of that field; a
+// 32 bit field of all ones reads back as -1.
+inline void writeHeaderField(char *page_buffer, size_t offset, size_t value)
 {
-    size_t page_id;
-    char buffer[kPageSize];
-};
+    if (offset < kOffsetOfKeySize)
+    {
+        uint32_t field = static_cast<uint32_t>(value);
+        std::memcpy(page_buffer + offset, &field, sizeof(field));
+    }
+    else if (offset < kOffsetOfLeaf)
+    {
+        uint16_t field = static_cast<uint16_t>(value);
+        std::memcpy(page_buffer + offset, &field, sizeof(field));
+    }
+    else
+        page_buffer[offset] = static_cast<char>(value);
+}
 
-using PagePtr = std::shared_ptr<Page>;
+inline size_t readHeaderField(const char *page_buffer, size_t offset)
+{
+    if (offset < kOffsetOfKeySize)
+    {
+        uint32_t field;
+        std::memcpy(&field, page_buffer + offset, sizeof(field));
+        return field == UINT32_MAX ? static_cast<size_t>(-1) : field;
+    }
+    else if (offset < kOffsetOfLeaf)
+    {
+        uint16_t field;
+        std::memcpy(&field, page_buffer + offset, sizeof(field));
+        return field;
+    }
+    return page_buffer[offset];
+}
+
+enum PageQueue
+{
+    kFreeQueue,
+    kA1inQueue,
+    kAmQueue,
+    kScanQueue
+};
 
-struct PageSchema
+struct PageHeader
 {
     bool leaf;
     size_t size;
@@ -38,13 +111,89 @@ struct PageSchema
     size_t key_size;
     size_t index_size;
     size_t value_size;
-    PagePtr page_ptr;
-    bool cmp;
+    size_t tree_id;
+    size_t prefix_size;
+    size_t heap_size;
     char *page_buffer;
-    int (*compare)(char *lhs, char *rhs, size_t);
     size_t total_size;
     size_t page_id;
-    PageSchema(bool l, size_t s, size_t left, size_t right, size_t key, size_t index, size_t value, bool c) : leaf(l), size(s), left_page_id(left), right_page_id(right), key_size(key), index_size(index), value_size(value), cmp(c) {}
+    size_t page_size;
+};
+
+struct Page
+{
+    size_t file_id;
+    size_t page_id;
+    char *buffer;
+    char *frame_buffer;
+    size_t page_size;
+    size_t pin_count;
+    PageQueue queue;
+    Page *prev;
+    Page *next;
+    bool header_valid;
+    bool io_pending;
+    PageHeader header;
+    Page(size_t id = -1, char *buf = nullptr) : file_id(-1), page_id(id), buffer(buf), frame_buffer(buf), page_size(kDefaultPageSize), pin_count(0), queue(kFreeQueue), prev(nullptr), next(nullptr), header_valid(false), io_pending(false) {}
+};
+
+class PagePtr
+{
+public:
+    PagePtr() : page_(nullptr) {}
+    explicit PagePtr(Page *page) : page_(page)
+    {
+        if (page_)
+            ++page_->pin_count;
+    }
+    PagePtr(const PagePtr &other) : PagePtr(other.page_) {}
+    PagePtr(PagePtr &&other) noexcept : page_(other.page_)
+    {
+        other.page_ = nullptr;
+    }
+    PagePtr &operator=(PagePtr other) noexcept
+    {
+        std::swap(page_, other.page_);
+        return *this;
+    }
+    ~PagePtr()
+    {
+        if (page_)
+            --page_->pin_count;
+    }
+    Page *operator->() const
+    {
+        return page_;
+    }
+    Page *get() const
+    {
+        return page_;
+    }
+    explicit operator bool() const
+    {
+        return page_ != nullptr;
+    }
+
+private:
+    Page *page_;
+};
+
+struct PageSchema : PageHeader
+{
+    PagePtr page_ptr;
+    PageSchema(bool l, size_t s, size_t left, size_t right, size_t key, size_t index, size_t value, size_t tree = 0)
+    {
+        leaf = l;
+        size = s;
+        left_page_id = left;
+        right_page_id = right;
+        key_size = key;
+        index_size = index;
+        value_size = value;
+        tree_id = tree;
+        prefix_size = 0;
+        heap_size = -1;
+    }
     PageSchema() = default;
 };
 
@@ -95,6 +95,8 @@ public:
 struct ColumnSchema
 {
     int data_type = 0;
+    bool varchar = false;
+    bool dictionary = false;
     bool not_null = false;
     bool null_default = true;
     bool unique = false;
@@ -103,12 +105,22 @@ struct ColumnSchema
     std::string reference_table_name;
     std::string reference_column_name;
     std::unordered_set<std::pair<std::string, std::string>, MyPairHashFunction, MyPairEqualFunction> be_reference_set;
+    std::vector<std::string> dictionary_vector;
+    mutable std::unordered_map<std::string, size_t> dictionary_map;
+    size_t column_root_page_id = -1;
+    size_t column_tree_id = 0;
+    bool zone_map = false;
 };
 
 struct TableSchema
 {
     size_t root_page_id;
     size_t max_id;
+    size_t tree_id = 0;
+    bool clustered = false;
+    bool compressed = false;
+    bool columnar = false;
+    size_t zone_root_page_id = -1;
     std::vector<std::string> column_order_vector;
     std::unordered_map<std::string, ColumnSchema> column_schema_map;
     std::unordered_set<std::string> primary_set;
@@ -116,27 +128,38 @@ struct TableSchema
     std::unordered_map<std::string, std::unordered_set<std::string>> index_column_map;
 };
 
+// page_size is serialized first so it sits at offset 0 of the file, where
+// FileSystem reads it before any page can be loaded.
 struct DatabaseSchema
 {
+    size_t page_size = kDefaultPageSize;
     std::vector<size_t> page_vector;
     Settings settings;
     std::deque<size_t> free_page_deque;
+    // The pages of free_page_deque, so a row hint can tell a freed leaf from
+    // a live one. It is rebuilt from the deque when the schema is read.
+    std::unordered_set<size_t> free_page_set;
     std::unordered_map<std::string, TableSchema> table_schema_map;
     size_t max_page = 0;
+    size_t max_tree_id = 0;
     void clear()
     {
         page_vector.clear();
         free_page_deque.clear();
+        free_page_set.clear();
         table_schema_map.clear();
     }
     void swap(DatabaseSchema &rhs)
     {
         using std::swap;
+        swap(page_size, rhs.page_size);
         swap(page_vector, rhs.page_vector);
         swap(settings, rhs.settings);
         swap(free_page_deque, rhs.free_page_deque);
+        swap(free_page_set, rhs.free_page_set);
         swap(table_schema_map, rhs.table_schema_map);
         swap(max_page, rhs.max_page);
+        swap(max_tree_id, rhs.max_tree_id);
     }
 };
 
@@ -3,48 +3,102 @@
 #include <fstream>
 #include <experimental/filesystem>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
 #include "const.h"
+#include "async_io.h"
 
 namespace fs = std::experimental::filesystem;
 
+constexpr size_t kMapAlignment = 4096;
+constexpr size_t kMapChunkSize = 1024 * kMapAlignment * 4;
+constexpr size_t kMapReserveSize = static_cast<size_t>(1) << 36;
+
+// A compressed page on disk keeps its header up to kOffsetOfPageCodec, then
+// the size and checksum of the codec output and the output itself, which
+// decodes to the rest of the page.
+constexpr size_t kOffsetOfCodecSize = kOffsetOfPageHeader;
+constexpr size_t kOffsetOfCodecChecksum = kOffsetOfCodecSize + sizeof(uint32_t);
+constexpr size_t kOffsetOfCodecBody = kOffsetOfCodecChecksum + sizeof(uint32_t);
+
+bool isValidPageSize(size_t page_size);
+
+struct DatabaseFile
+{
+  std::string filename;
+  size_t file_size = 0;
+  size_t page_size = kDefaultPageSize;
+  int fd = -1;
+  char *map = nullptr;
+  size_t map_size = 0;
+  std::unordered_set<size_t> compressed_tree_set;
+  bool punch_hole = true;
+};
+
+// Every database file that has been used stays open under its own file id,
+// so pages of several databases can share the buffer pool. Pages are moved
+// with pread/pwrite at the page size recorded in the file's schema header;
+// with direct I/O on the page cache is bypassed and frames are the only copy.
+// In mmap mode each file owns a reserved address range that is mapped in
+// kMapChunkSize steps, so a page's address never changes; frames point
+// straight into the mapping and read/write copy nothing.
+// readAsync() starts a read into a frame and pins it until the read is
+// collected by waitRead() or reapReads().
+// Pages of the trees given to setCompressedTrees() are compressed as they
+// are written, and the blocks the compressed copy leaves unused are punched
+// out of the file, unless its filesystem cannot punch holes. Any compressed
+// page is decoded as it is read. Frames always hold pages as they are, so in
+// mmap mode nothing is compressed, and a compressed page is decoded in place
+// in the mapping, which leaves it stored uncompressed.
 class FileSystem
 {
 public:
-  void read(size_t page_id, PagePtr page_ptr)
-  {
-    if ((page_id + 1) * kPageSize > file_size_)
-    {
-      write(page_id, page_ptr);
-    }
-    file_.seekg(page_id * kPageSize);
-    file_.read(page_ptr->buffer, kPageSize);
-  };
-  void write(size_t page_id, PagePtr page_ptr)
-  {
-    file_.seekp(page_id * kPageSize);
-    file_.write(page_ptr->buffer, kPageSize);
-    file_.flush();
-    if ((page_id + 1) * kPageSize > file_size_)
-      file_size_ = (page_id + 1) * kPageSize;
-  }
-  void setFile(std::string filename)
-  {
-    file_size_ = 0;
-    if (file_.is_open())
-    {
-      file_.close();
-    }
-    if (!filename.empty())
-    {
-      file_.open(filename, std::fstream::in | std::fstream::out | std::fstream::binary);
-      file_.seekg(0, file_.end);
-      file_size_ = file_.tellg();
-    }
-    filename_ = filename;
+  void read(size_t page_id, const PagePtr &page_ptr);
+  void write(size_t page_id, const PagePtr &page_ptr);
+  size_t readPages(size_t first_page_id, const std::vector<PagePtr> &page_ptr_vector);
+  bool readAsync(size_t page_id, Page *page);
+  void waitRead(Page *page);
+  void reapReads();
+  void drainReads();
+  size_t readsInFlight() const
+  {
+    return async_io_.inFlight();
+  }
+  void setFile(std::string filename);
+  size_t closeFile(const std::string &filename);
+  size_t getFileId()
+  {
+    return file_id_;
+  }
+  void setMmap(bool mmap)
+  {
+    mmap_ = mmap;
+  }
+  bool isMmap() const
+  {
+    return mmap_;
+  }
+  void setDirectIo(bool direct_io)
+  {
+    direct_io_ = direct_io;
+  }
+  void setCompressedTrees(std::unordered_set<size_t> tree_id_set)
+  {
+    if (file_id_ != -1)
+      file_map_[file_id_].compressed_tree_set.swap(tree_id_set);
   }
+  size_t pageSize()
+  {
+    return file_id_ == -1 ? kDefaultPageSize : file_map_[file_id_].page_size;
+  }
+  void adviseWillNeed(size_t first_page_id, size_t count);
   std::string getFilename()
   {
-    return filename_;
+    return file_id_ == -1 ? "" : file_map_[file_id_].filename;
   }
   bool exists(std::string name)
   {
@@ -58,10 +112,6 @@ public:
   {
     return fs::directory_iterator(name);
   }
-  void swap(std::fstream &other_file)
-  {
-    file_.swap(other_file);
-  }
   bool remove(const std::string filename)
   {
     return fs::remove(filename);
@@ -72,21 +122,51 @@ public:
   }
   ~FileSystem()
   {
-    if (file_)
-      file_.close();
+    drainReads();
+    for (auto &&i : file_map_)
+      closeDatabaseFile(i.second);
+    free(codec_buffer_);
   }
   size_t size()
   {
-    file_.seekg(std::fstream::end);
-    return file_.tellg();
+    return file_id_ == -1 ? 0 : file_map_[file_id_].file_size;
+  }
+  size_t readCount() const
+  {
+    return read_count_;
+  }
+  size_t writeCount() const
+  {
+    return write_count_;
+  }
+  size_t compressedWriteCount() const
+  {
+    return compressed_write_count_;
   }
   static FileSystem &getInstance();
 
 private:
   FileSystem() {}
-  std::fstream file_;
-  std::string filename_;
-  size_t file_size_ = 0;
+  void completeRead(Page *page, bool success);
+  size_t compressPage(const DatabaseFile &database_file, const char *buffer);
+  void decompressPage(Page *page);
+  void allocateCodecBuffer();
+  void openDatabaseFile(DatabaseFile &database_file);
+  void closeDatabaseFile(DatabaseFile &database_file);
+  void openMapping(DatabaseFile &database_file);
+  char *mapPage(DatabaseFile &database_file, size_t page_id);
+
+  std::unordered_map<size_t, DatabaseFile> file_map_;
+  std::unordered_map<std::string, size_t> file_id_map_;
+  size_t file_id_ = -1;
+  size_t next_file_id_ = 0;
+  bool mmap_ = false;
+  bool direct_io_ = false;
+  AsyncIo async_io_;
+  size_t read_count_ = 0;
+  size_t write_count_ = 0;
+  size_t compressed_write_count_ = 0;
+  char *codec_buffer_ = nullptr;
 };
 
 #endif
\ No newline at end of file
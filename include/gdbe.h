@@ -12,6 +12,8 @@
 #include "utility.h"
 
 const std::string kDatabaseDir = "database/";
+const std::string kWarmupDir = "warmup/";
+constexpr size_t kWarmupInterval = 1000;
 
 class GDBE
 {
@@ -43,11 +45,33 @@ public:
   void execDropTable(const Node &);
   void execDropIndex(const Node &);
   void execExplain(const Node &);
+  void execTruncate(const Node &);
+  void execSet(const Node &);
+  void execShowBufferPool(const Node &);
+  void dumpWarmup();
+  void loadWarmup();
+  void truncateTable(TableSchema &table_schema);
+  void freeTableOverflow(const TableSchema &table_schema);
+  void setCompressedTrees();
+  void insertColumns(TableSchema &table_schema, char *key, const std::vector<Token> &values);
+  void deleteColumns(TableSchema &table_schema, char *key);
+  size_t zoneCapacity(const TableSchema &table_schema);
+  void initZoneTree(TableSchema &table_schema);
+  void insertZone(TableSchema &table_schema, char *key, const std::vector<Token> &values);
+  void deleteZone(TableSchema &table_schema, char *key);
+  void refreshZone(TableSchema &table_schema, std::vector<char> &zone);
+  bool isRangeDelete(const std::string &table_name, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition_map);
+  void deleteRange(const std::string &table_name, std::pair<IndexSchema, std::pair<Token, Token>> index_condition);
   size_t getExprDataType(const Node &node);
   size_t getValueSize(const std::unordered_map<std::string, ColumnSchema> &column_schema_map);
   void updateDatabaseSchema();
-  void selectRecursive(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &, const std::unordered_set<std::string> &, const std::vector<Node> &select_expr_vector, size_t limit);
-  void selectRecursiveAux(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, std::unordered_set<std::string> table_set, std::unordered_set<std::string>, const std::unordered_map<std::string, std::unordered_map<std::string, Token>> table_column, const std::vector<Node> &select_expr_vector, size_t limit);
+  bool clusteredRange(const TableSchema &table_schema, const std::pair<IndexSchema, std::pair<Token, Token>> &index_condition, char **begin_key_ptr, char **end_key_ptr);
+  bool nextKeyBatch(Iter &iter, Iter &end, size_t key_size, std::vector<char> &key_buffer, std::vector<char *> &key_vector);
+  std::vector<std::unordered_map<std::string, Token>> readRowBatch(const TableSchema &table_schema, const std::vector<char *> &key_vector, bool free_overflow);
+  void checkReferenceBatch(const TableSchema &table_schema, const std::vector<char *> &key_vector, std::unordered_map<std::string, size_t> &table_id_page_id_map);
+  void deleteRowBatch(const std::string &table_name, const std::vector<char *> &key_vector);
+  void selectRecursive(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &, const std::unordered_set<std::string> &, const std::vector<Node> &select_expr_vector, size_t limit, const std::unordered_map<std::string, std::unordered_set<std::string>> &table_column_set_map);
+  void selectRecursiveAux(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, std::unordered_set<std::string> table_set, std::unordered_set<std::string>, const std::unordered_map<std::string, std::unordered_map<std::string, Token>> table_column, const std::vector<Node> &select_expr_vector, size_t limit, const std::unordered_map<std::string, std::unordered_set<std::string>> &table_column_set_map);
   void deleteRecursive(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &, const std::unordered_set<std::string> &, const std::unordered_set<std::string> &, std::unordered_map<std::string, size_t> &table_id_page_map);
   void deleteRecursiveAux(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, std::unordered_set<std::string> table_set, std::unordered_set<std::string>, const std::unordered_map<std::string, std::unordered_map<std::string, Token>> table_column, const std::unordered_set<std::string> &, std::unordered_map<std::string, size_t> &table_id_page_map, std::unordered_map<std::string, size_t> table_id_map);
   std::pair<IndexSchema, std::pair<Token, Token>> getCondition(std::vector<Node> &expr_vector, bool *rc);
@@ -61,6 +85,7 @@ public:
     {
       size_t temp = database_schema_.free_page_deque.front();
       database_schema_.free_page_deque.pop_front();
+      database_schema_.free_page_set.erase(temp);
       return temp;
     }
   }
@@ -68,6 +93,12 @@ public:
   void addFreePage(size_t page_id)
   {
     database_schema_.free_page_deque.push_back(page_id);
+    database_schema_.free_page_set.insert(page_id);
+  }
+
+  bool isFreePage(size_t page_id) const
+  {
+    return database_schema_.free_page_set.count(page_id);
   }
 
 private:
@@ -79,6 +110,8 @@ private:
   Result result_;
   std::string database_name_;
   DatabaseSchema database_schema_;
+  std::unordered_map<std::string, DatabaseSchema> database_schema_map_;
+  size_t statement_count_ = 0;
 };
 
 #endif
@@ -0,0 +1,24 @@
+#ifndef PAGE_CODEC_H_
+#define PAGE_CODEC_H_
+#include <cstddef>
+#include <cstdint>
+
+// A byte-oriented LZ codec in the manner of LZ4: a block is a run of
+// sequences, each a token byte with the literal count in its high nibble and
+// the match length less kMinMatchSize in its low one, longer counts going on
+// in bytes of 255, then the literals, a two byte offset and the match. The
+// last sequence has literals only.
+constexpr size_t kMinMatchSize = 4;
+constexpr size_t kMaxMatchOffset = UINT16_MAX;
+
+// Compresses size bytes at src into dst, which holds capacity bytes, and
+// returns the compressed size, or 0 when it does not fit.
+size_t compressBlock(const char *src, size_t size, char *dst, size_t capacity);
+
+// Decodes src_size bytes at src into dst. Fails unless they make up exactly
+// size bytes.
+bool decompressBlock(const char *src, size_t src_size, char *dst, size_t size);
+
+uint32_t blockChecksum(const char *data, size_t size);
+
+#endif
@@ -63,6 +63,8 @@ private:
   Node parseForeigns();
   Node parseForeign();
   Node parseExplain();
+  Node parseTruncate();
+  Node parseSet();
   Node *build(Node new_node, Node *parent = nullptr)
   {
     return syntax_tree_.insert(new_node, parent);
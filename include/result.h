@@ -22,7 +22,10 @@ enum ResultType
     kCreateIndexResult,
     kShowIndexResult,
     kDropIndexResult,
-    kInsertResult
+    kInsertResult,
+    kTruncateResult,
+    kSetResult,
+    kShowBufferPoolResult
 };
 
 struct Result
@@ -0,0 +1,16 @@
+#ifndef SIMD_SEARCH_H_
+#define SIMD_SEARCH_H_
+#include <cstddef>
+#include <cstdint>
+
+// Binary search in a page stops once this many entries are left and hands
+// them to countWordsBelow.
+constexpr size_t kSimdSearchWindow = 16;
+
+// Counts the leading entries among count sorted entries, step bytes apart,
+// whose big-endian word at base is less than key, or not greater than it with
+// inclusive. An AVX2 or SSE4.2 kernel is picked on first use from what the CPU
+// supports, with a scalar loop for everything else.
+size_t countWordsBelow(const char *base, size_t step, size_t count, uint64_t key, bool inclusive);
+
+#endif
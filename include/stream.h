@@ -75,7 +75,7 @@ Stream &operator<<(Stream &, const std::vector<T> &data);
 struct Stream
 {
 public:
-  Stream(std::vector<PagePtr> page_ptr_vector) : total_size_(page_ptr_vector.size() * kPageSize), total_pos_(0), vector_index_(0), vector_pos_(0)
+  Stream(std::vector<PagePtr> page_ptr_vector) : page_size_(page_ptr_vector.empty() ? kDefaultPageSize : page_ptr_vector.front()->page_size), total_size_(page_ptr_vector.size() * page_size_), total_pos_(0), vector_index_(0), vector_pos_(0)
   {
     for (auto &&i : page_ptr_vector)
     {
@@ -89,13 +89,16 @@ public:
     {
       buffer_vector_.push_back(i->buffer);
     }
-    total_size_ = page_ptr_vector.size() * kPageSize;
+    if (!page_ptr_vector.empty())
+      page_size_ = page_ptr_vector.front()->page_size;
+    total_size_ = page_ptr_vector.size() * page_size_;
     total_pos_ = 0;
     vector_index_ = 0;
     vector_pos_ = 0;
   }
 
   std::vector<char *> buffer_vector_;
+  size_t page_size_;
   size_t total_size_;
   size_t total_pos_;
   size_t vector_index_;
@@ -109,7 +112,7 @@ Stream &operator<<(Stream &stream, const T &data)
     throw Error(kMemoryError, "Memory error");
   size_t data_size = sizeof(T);
   size_t current_copy_size = 0;
-  size_t capacy = kPageSize - stream.vector_pos_;
+  size_t capacy = stream.page_size_ - stream.vector_pos_;
   while (data_size > capacy)
   {
     std::copy(reinterpret_cast<const char *>(&data) + current_copy_size, reinterpret_cast<const char *>(&data) + current_copy_size + capacy, stream.buffer_vector_[stream.vector_index_] + stream.vector_pos_);
@@ -117,7 +120,7 @@ Stream &operator<<(Stream &stream, const T &data)
     data_size -= capacy;
     stream.vector_pos_ = 0;
     ++stream.vector_index_;
-    capacy = kPageSize;
+    capacy = stream.page_size_;
   }
   std::copy(reinterpret_cast<const char *>(&data) + current_copy_size, reinterpret_cast<const char *>(&data) + current_copy_size + data_size, stream.buffer_vector_[stream.vector_index_] + stream.vector_pos_);
   stream.total_pos_ += data_size;
@@ -184,7 +187,7 @@ Stream &operator>>(Stream &stream, T &data)
     throw Error(kMemoryError, "Memory error");
   size_t data_size = sizeof(T);
   size_t current_copy_size = 0;
-  size_t capacy = kPageSize - stream.vector_pos_;
+  size_t capacy = stream.page_size_ - stream.vector_pos_;
   while (data_size > capacy)
   {
     std::copy(reinterpret_cast<const T *>(stream.buffer_vector_[stream.vector_index_] + stream.vector_pos_), reinterpret_cast<const T *>(stream.buffer_vector_[stream.vector_index_] + stream.vector_pos_ + capacy), &data + current_copy_size);
@@ -192,7 +195,7 @@ Stream &operator>>(Stream &stream, T &data)
     data_size -= capacy;
     stream.vector_pos_ = 0;
     ++stream.vector_index_;
-    capacy = kPageSize;
+    capacy = stream.page_size_;
   }
   std::copy(reinterpret_cast<const T *>(stream.buffer_vector_[stream.vector_index_] + stream.vector_pos_), reinterpret_cast<const T *>(stream.buffer_vector_[stream.vector_index_] + stream.vector_pos_ + data_size), &data + current_copy_size);
   stream.total_pos_ += data_size;
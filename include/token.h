@@ -41,6 +41,19 @@ enum TokenType
     kDefault,
     kExplain,
     kUnique,
+    kTruncate,
+    kBetween,
+    kBuffer,
+    kPool,
+    kBufferPoolSize,
+    kPageSize,
+    kClustered,
+    kVarchar,
+    kDictionary,
+    kCompressed,
+    kEngine,
+    kColumnar,
+    kZoneMap,
 
     kAnd,
     kNot,
@@ -91,6 +104,9 @@ struct Token
     TokenType token_type;
     long num;
     std::string str;
+    // The overflow chain of the table row a long string was read from, so the
+    // value can be written again as a reference to it, or -1.
+    size_t overflow_page_id = -1;
     operator bool()
     {
         return token_type != kNone;
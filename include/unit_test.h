@@ -8,7 +8,7 @@
 #include <fstream>
 #include <queue>
 
-constexpr size_t size = 20;
+constexpr size_t size = 31;
 
 namespace unittest
 {
@@ -17,9 +17,16 @@ class Test
 private:
     std::string sql_arr[size] = {
         "CREATE DATABASE gsql;",
+        "CREATE DATABASE small PAGE_SIZE = 4096;",
         "SHOW DATABASES;",
         "USE gsql;",
         "CREATE TABLE gsql.test(id INT DEFAULT 1, test.val INT NOT NULL DEFAULT 'fdjsl' UNIQUE DEFAULT 'fls', name CHAR(10), FOREIGN KEY(val) REFERENCES other(name), PRIMARY KEY(test.id,gsql.test.val));",
+        "CREATE TABLE gsql.by_id(id INT, val CHAR(10), PRIMARY KEY(id)) CLUSTERED;",
+        "CREATE TABLE gsql.archive(id INT, val CHAR(10), PRIMARY KEY(id)) CLUSTERED COMPRESSED;",
+        "CREATE TABLE gsql.event(id INT, kind CHAR(16) DICTIONARY, ts INT, PRIMARY KEY(id)) ENGINE = COLUMNAR;",
+        "CREATE TABLE gsql.log(id INT, ts INT ZONEMAP, msg CHAR(40), PRIMARY KEY(id));",
+        "CREATE TABLE gsql.note(id INT, body VARCHAR(255), PRIMARY KEY(id));",
+        "CREATE TABLE gsql.tag(id INT, color CHAR(16) DICTIONARY NOT NULL, PRIMARY KEY(id));",
         "SHOW TABLES;",
         "CREATE INDEX i ON gsql.test(gsql.test.id,val);",
         "SHOW INDEX FROM gsql.test;",
@@ -30,11 +37,15 @@ private:
         "SELECT 9*9-(8+5)=8*4/5 FROM test JOIN other ON test.name=other.name JOIN another on other.val = another.val where test.id=1;",
         "UPDATE test SET id=id&1;",
         "DELETE test FROM test,another join other on another.id=other.id WHERE id>6;",
+        "DELETE FROM test WHERE id BETWEEN 2 AND 5;",
+        "TRUNCATE TABLE gsql.test;",
         "ALTER TABLE test ADD str CHAR;",
         "DROP TABLE test;",
         "DROP DATABASE gsql;",
         "DROP INDEX test ON gsql;",
         "EXPLAIN gsql.test;",
+        "SET BUFFER_POOL_SIZE = 4096;",
+        "SHOW BUFFER POOL;",
         "EXIT;"};
 
 public:
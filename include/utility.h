@@ -7,6 +7,7 @@
 #include <vector>
 #include <unordered_set>
 #include "database_schema.h"
+#include "b_plus_tree.h"
 
 std::string getTableName(const Node &name_node, const std::string &database_name);
 
@@ -16,9 +17,110 @@ int doNothing(int count, int key);
 
 void serilization(const std::vector<Token> &values, const std::vector<size_t> &values_size, char *values_ptr);
 
-std::unordered_map<std::string, Token> toTokenMap(const char *value, const TableSchema &table_schema, size_t key_size, size_t *id);
+size_t inlineLimit(std::vector<size_t> width_vector, size_t room);
 
-std::vector<Token> toTokenResultVector(const char *value, const std::vector<int> data_type_vector, size_t key_size);
+size_t overflowThreshold(const std::unordered_map<std::string, ColumnSchema> &column_schema_map);
+
+void serializeOverflow(const char *data, size_t size, char *value);
+
+void referenceOverflow(const char *data, size_t size, size_t page_id, char *value);
+
+std::string deserializeOverflow(const char *value, bool fetch);
+
+size_t overflowPageId(const char *value);
+
+bool hasOverflow(const TableSchema &table_schema);
+
+void freeRowOverflow(const char *value, const TableSchema &table_schema);
+
+size_t dictionaryCode(const ColumnSchema &column_schema, const std::string &value);
+
+size_t addDictionaryValue(ColumnSchema &column_schema, const std::string &value);
+
+struct DictionaryFilter
+{
+    size_t code_pos;
+    uint16_t code;
+    size_t null_pos;
+    char null_mask;
+};
+
+bool dictionaryFilter(const TableSchema &table_schema, const std::vector<Node> &condition_vector, std::vector<DictionaryFilter> *filter_vector);
+
+bool matchDictionaryFilter(const char *value, const std::vector<DictionaryFilter> &filter_vector);
+
+size_t fixedColumnSize(const ColumnSchema &column_schema);
+
+void rowLayout(const TableSchema &table_schema, size_t *bitmap_pos, size_t *fixed_pos, size_t *varchar_pos);
+
+size_t serializeRow(const std::vector<Token> &values, const TableSchema &table_schema, char *row);
+
+void serializeKey(const Token &value, size_t size, char *key);
+
+void serializeId(size_t id, char *key);
+
+size_t deserializeId(const char *key);
+
+void serializeRowKey(size_t id, char *key);
+
+std::unordered_map<std::string, Token> toTokenMap(const char *value, const TableSchema &table_schema, size_t key_size, size_t *id, const std::unordered_set<std::string> *column_set = nullptr);
+
+size_t columnValueSize(const ColumnSchema &column_schema);
+
+void serializeColumnValue(const Token &value, const ColumnSchema &column_schema, char *column_value);
+
+Token deserializeColumnValue(const char *column_value, const ColumnSchema &column_schema);
+
+std::vector<std::unordered_map<std::string, Token>> columnTokenMaps(const TableSchema &table_schema, const std::vector<char *> &key_vector, const std::unordered_set<std::string> *column_set = nullptr);
+
+// Walks the column trees of a COLUMNAR table in step with a scan of its
+// table tree from begin_key to end_key. Each column tree holds the keys of
+// the table tree, so the entries at the same step are one row. Only the
+// columns in column_set are read.
+class ColumnCursor
+{
+public:
+    ColumnCursor(const TableSchema &table_schema, const std::unordered_set<std::string> *column_set, char *begin_key, char *end_key);
+    std::unordered_map<std::string, Token> next();
+
+private:
+    std::vector<std::pair<std::string, const ColumnSchema *>> column_vector_;
+    std::vector<Iter> iter_vector_;
+    std::vector<std::string> null_column_vector_;
+};
+
+// A table with ZONEMAP columns keeps a zone tree beside its table tree. A
+// zone is a run of rows with adjacent keys, about a leaf of them. Its entry
+// is keyed by the key the zone ends before and holds the key it begins at, its
+// row count and the range of each ZONEMAP column, so a scan can pass over the
+// zones that no row it looks for can be in. The last zone ends past every
+// key.
+std::vector<std::string> zoneColumnVector(const TableSchema &table_schema);
+
+size_t zoneValueSize(const TableSchema &table_schema);
+
+void emptyZone(const TableSchema &table_schema, const char *begin_key, char *zone_value);
+
+void widenZone(const TableSchema &table_schema, const std::unordered_map<std::string, Token> &column_token_map, char *zone_value);
+
+void summarizeZone(const TableSchema &table_schema, const char *end_key, char *zone_value);
+
+std::vector<char> findZone(const TableSchema &table_schema, char *key);
+
+struct ZoneFilter
+{
+    size_t range_pos;
+    long low;
+    long high;
+};
+
+bool zoneFilter(const TableSchema &table_schema, const std::vector<Node> &condition_vector, std::vector<ZoneFilter> *filter_vector);
+
+bool matchZoneFilter(const char *zone_value, const std::vector<ZoneFilter> &filter_vector);
+
+std::vector<std::pair<std::string, std::string>> zoneRuns(const TableSchema &table_schema, const std::vector<ZoneFilter> &filter_vector, char *begin_key, char *end_key);
+
+std::vector<Token> toTokenResultVector(const char *value, const std::vector<int> data_type_vector, const std::vector<size_t> &value_size_vector, size_t key_size);
 
 void convertInt(Token &token);
 
@@ -38,10 +140,8 @@ bool partitionConditionForTable(const std::vector<Node> &, std::unordered_map<st
 
 void getTableSet(const Node &, std::unordered_set<std::string> *);
 
-bool isIndexCondition(const Node &node);
-
-int compareInt(char *lhs, char *rhs, size_t size);
+void getColumnSet(const Node &, std::unordered_map<std::string, std::unordered_set<std::string>> *);
 
-int compareString(char *lhs, char *rhs, size_t size);
+bool isIndexCondition(const Node &node);
 
 #endif
\ No newline at end of file
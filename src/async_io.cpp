@@ -0,0 +1,209 @@
+#include <cstring>
+#include <unistd.h>
+#include "async_io.h"
+#ifdef GSQL_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+AsyncIo::~AsyncIo()
+{
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    request_cv_.notify_all();
+    for (auto &&worker : worker_vector_)
+        worker.join();
+#ifdef GSQL_IO_URING
+    if (ring_fd_ != -1)
+    {
+        munmap(sq_ring_, sq_ring_size_);
+        munmap(cq_ring_, cq_ring_size_);
+        munmap(sqe_array_, sqe_array_size_);
+        close(ring_fd_);
+    }
+#endif
+}
+
+void AsyncIo::start()
+{
+    started_ = true;
+#ifdef GSQL_IO_URING
+    if (setupRing())
+        return;
+#endif
+    for (size_t i = 0; i < kIoThreadCount; ++i)
+        worker_vector_.emplace_back(&AsyncIo::work, this);
+}
+
+void AsyncIo::submit(Page *page, int fd, size_t offset, size_t size)
+{
+    if (!started_)
+        start();
+    while (pending_map_.size() - completed_map_.size() >= kIoRingSize)
+        collect(true);
+    pending_map_[page] = size;
+    IoRequest request{page, fd, offset, size, 0};
+#ifdef GSQL_IO_URING
+    if (ring_fd_ != -1)
+    {
+        submitRing(request);
+        return;
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        request_deque_.push_back(request);
+    }
+    request_cv_.notify_one();
+}
+
+bool AsyncIo::wait(Page *page)
+{
+    if (pending_map_.find(page) == pending_map_.end())
+        return true;
+    while (completed_map_.find(page) == completed_map_.end())
+        collect(true);
+    bool success = completed_map_[page];
+    completed_map_.erase(page);
+    pending_map_.erase(page);
+    return success;
+}
+
+std::vector<std::pair<Page *, bool>> AsyncIo::reap()
+{
+    std::vector<std::pair<Page *, bool>> result;
+    if (pending_map_.empty())
+        return result;
+    collect(false);
+    for (auto &&i : completed_map_)
+    {
+        pending_map_.erase(i.first);
+        result.push_back(i);
+    }
+    completed_map_.clear();
+    return result;
+}
+
+std::vector<std::pair<Page *, bool>> AsyncIo::drain()
+{
+    while (completed_map_.size() < pending_map_.size())
+        collect(true);
+    return reap();
+}
+
+void AsyncIo::collect(bool block)
+{
+#ifdef GSQL_IO_URING
+    if (ring_fd_ != -1)
+    {
+        collectRing(block);
+        return;
+    }
+#endif
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (block)
+        done_cv_.wait(lock, [this] { return !done_vector_.empty(); });
+    for (auto &&request : done_vector_)
+        completed_map_[request.page] = request.result == static_cast<long>(request.size);
+    done_vector_.clear();
+}
+
+void AsyncIo::work()
+{
+    while (true)
+    {
+        IoRequest request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            request_cv_.wait(lock, [this] { return stop_ || !request_deque_.empty(); });
+            if (stop_ && request_deque_.empty())
+                return;
+            request = request_deque_.front();
+            request_deque_.pop_front();
+        }
+        request.result = pread(request.fd, request.page->buffer, request.size, request.offset);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_vector_.push_back(request);
+        }
+        done_cv_.notify_one();
+    }
+}
+
+#ifdef GSQL_IO_URING
+bool AsyncIo::setupRing()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int ring_fd = syscall(__NR_io_uring_setup, kIoRingSize, &params);
+    if (ring_fd < 0)
+        return false;
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    sqe_array_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    sqe_array_ = mmap(nullptr, sqe_array_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqe_array_ == MAP_FAILED)
+    {
+        if (sq_ring_ != MAP_FAILED)
+            munmap(sq_ring_, sq_ring_size_);
+        if (cq_ring_ != MAP_FAILED)
+            munmap(cq_ring_, cq_ring_size_);
+        if (sqe_array_ != MAP_FAILED)
+            munmap(sqe_array_, sqe_array_size_);
+        close(ring_fd);
+        return false;
+    }
+    char *sq_ring = static_cast<char *>(sq_ring_);
+    char *cq_ring = static_cast<char *>(cq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+    cqe_array_ = cq_ring + params.cq_off.cqes;
+    ring_fd_ = ring_fd;
+    return true;
+}
+
+void AsyncIo::submitRing(const IoRequest &request)
+{
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqe_array_) + index;
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = request.fd;
+    sqe->off = request.offset;
+    sqe->addr = reinterpret_cast<unsigned long>(request.page->buffer);
+    sqe->len = request.size;
+    sqe->user_data = reinterpret_cast<unsigned long>(request.page);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0);
+}
+
+void AsyncIo::collectRing(bool block)
+{
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail && block)
+    {
+        syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    }
+    for (; head != tail; ++head)
+    {
+        const io_uring_cqe *cqe = static_cast<const io_uring_cqe *>(cqe_array_) + (head & *cq_mask_);
+        Page *page = reinterpret_cast<Page *>(cqe->user_data);
+        completed_map_[page] = cqe->res == static_cast<int>(pending_map_[page]);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+#endif
\ No newline at end of file
@@ -1,64 +1,436 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include "b_plus_tree.h"
 #include "gdbe.h"
+#include "simd_search.h"
 
-bool pageIsFull(const PageSchema &page_schema)
+// Keys of INT columns, row ids and CHAR columns a multiple of eight wide are
+// a flag byte followed by big-endian words, so they compare a word at a time.
+template <size_t kWords>
+struct WordKey
 {
-    return (kPageSize - kOffsetOfPageHeader) / (page_schema.key_size + page_schema.value_size) <= page_schema.size;
+    static constexpr bool kVector = kWords == 1;
+    static uint64_t load(const char *key)
+    {
+        uint64_t word;
+        std::memcpy(&word, key, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        return word;
+    }
+    static int compare(const char *lhs, const char *rhs, size_t)
+    {
+        if (lhs[0] != rhs[0])
+            return static_cast<unsigned char>(lhs[0]) < static_cast<unsigned char>(rhs[0]) ? -1 : 1;
+        for (size_t i = 0; i < kWords; ++i)
+        {
+            uint64_t lhs_word = load(lhs + kSizeOfBool + i * sizeof(uint64_t));
+            uint64_t rhs_word = load(rhs + kSizeOfBool + i * sizeof(uint64_t));
+            if (lhs_word != rhs_word)
+                return lhs_word < rhs_word ? -1 : 1;
+        }
+        return 0;
+    }
+};
+
+struct ByteKey
+{
+    static constexpr bool kVector = false;
+    static int compare(const char *lhs, const char *rhs, size_t size)
+    {
+        return std::memcmp(lhs, rhs, size);
+    }
+};
+
+// Binary search over the entries of a page from pos on. With kInclusive it
+// returns the first entry greater than key, otherwise the first entry not
+// less than it. Single-word keys finish the last kSimdSearchWindow entries
+// with countWordsBelow once the flag bytes on both sides are known to be set.
+template <typename Key, bool kInclusive>
+size_t searchPage(const PageHeader &page_schema, size_t pos, const char *key, size_t compare_size)
+{
+    size_t step = page_schema.key_size + page_schema.value_size;
+    size_t low = (pos - kOffsetOfPageHeader) / step;
+    size_t high = page_schema.size;
+    while (low < high)
+    {
+        const char *entry = page_schema.page_buffer + kOffsetOfPageHeader + low * step;
+        if (Key::kVector && high - low <= kSimdSearchWindow && key[0] && entry[0])
+            return kOffsetOfPageHeader + (low + countWordsBelow(entry + kSizeOfBool, step, high - low, WordKey<1>::load(key + kSizeOfBool), kInclusive)) * step;
+        size_t middle = low + (high - low) / 2;
+        int result = Key::compare(key, page_schema.page_buffer + kOffsetOfPageHeader + middle * step, compare_size);
+        if (kInclusive ? result >= 0 : result > 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return kOffsetOfPageHeader + low * step;
+}
+
+template <bool kInclusive>
+size_t searchPage(const PageHeader &page_schema, size_t pos, const char *key, size_t compare_size)
+{
+    if (page_schema.prefix_size)
+    {
+        int result = std::memcmp(key, pagePrefix(page_schema), page_schema.prefix_size);
+        if (result)
+            return result < 0 ? pos : page_schema.total_size;
+        return searchPage<ByteKey, kInclusive>(page_schema, pos, key + page_schema.prefix_size, compare_size);
+    }
+    switch (compare_size)
+    {
+    case kSizeOfBool + kSizeOfSizeT:
+        return searchPage<WordKey<1>, kInclusive>(page_schema, pos, key, compare_size);
+    case kSizeOfBool + 2 * kSizeOfSizeT:
+        return searchPage<WordKey<2>, kInclusive>(page_schema, pos, key, compare_size);
+    case kSizeOfBool + 3 * kSizeOfSizeT:
+        return searchPage<WordKey<3>, kInclusive>(page_schema, pos, key, compare_size);
+    case kSizeOfBool + 4 * kSizeOfSizeT:
+        return searchPage<WordKey<4>, kInclusive>(page_schema, pos, key, compare_size);
+    default:
+        return searchPage<ByteKey, kInclusive>(page_schema, pos, key, compare_size);
+    }
+}
+
+size_t upperBoundInPage(const PageHeader &page_schema, size_t pos, const char *key, size_t compare_size)
+{
+    return searchPage<true>(page_schema, pos, key, compare_size);
+}
+
+size_t lowerBoundInPage(const PageHeader &page_schema, size_t pos, const char *key, size_t compare_size)
+{
+    return searchPage<false>(page_schema, pos, key, compare_size);
+}
+
+// Leaves of indexes on keys wider than a word keep the bytes all their keys
+// share once, at the end of the page, and store only the rest of each key.
+// key_size and index_size in the header of such a page count the stored
+// bytes; add prefix_size for the full width. Internal pages are never
+// compressed.
+bool pageIsCompressible(const PageHeader &page_schema)
+{
+    return page_schema.leaf && page_schema.index_size + page_schema.prefix_size > kSizeOfBool + kSizeOfSizeT;
+}
+
+const char *pagePrefix(const PageHeader &page_schema)
+{
+    return page_schema.page_buffer + page_schema.page_size - page_schema.prefix_size;
+}
+
+void copyKey(const PageHeader &page_schema, const char *entry, char *key)
+{
+    std::copy(pagePrefix(page_schema), pagePrefix(page_schema) + page_schema.prefix_size, key);
+    std::copy(entry, entry + page_schema.key_size, key + page_schema.prefix_size);
+}
+
+void copyEntry(const PageHeader &page_schema, const char *entry, char *record)
+{
+    copyKey(page_schema, entry, record);
+    std::copy(entry + page_schema.key_size, entry + page_schema.key_size + page_schema.value_size, record + page_schema.prefix_size + page_schema.key_size);
+}
+
+// Compares a full key with an entry of the page; compare_size counts stored
+// bytes, as the header sizes do.
+int compareEntry(const PageHeader &page_schema, const char *key, const char *entry, size_t compare_size)
+{
+    int result = std::memcmp(key, pagePrefix(page_schema), page_schema.prefix_size);
+    return result ? result : std::memcmp(key + page_schema.prefix_size, entry, compare_size);
+}
+
+// The prefix a compressible leaf can keep once key is added. A key that does
+// not share the whole prefix sorts before or after every entry of the page.
+size_t prefixWith(const PageHeader &page_schema, const char *key)
+{
+    if (!pageIsCompressible(page_schema))
+        return 0;
+    if (page_schema.size == 0)
+        return page_schema.index_size + page_schema.prefix_size;
+    const char *prefix = pagePrefix(page_schema);
+    return std::mismatch(prefix, prefix + page_schema.prefix_size, key).first - prefix;
 }
 
+// Re-encodes the entries of a leaf around the first prefix_size bytes of
+// prefix. A longer prefix must be shared by every entry, and the caller makes
+// sure the entries still fit when it gets shorter. A leaf emptied by deletes
+// still holds the prefix of its old entries, so it is always rewritten.
+void setPagePrefix(PageSchema &page_schema, const char *prefix, size_t prefix_size)
+{
+    size_t old_prefix_size = page_schema.prefix_size;
+    if (prefix_size == old_prefix_size && page_schema.size)
+        return;
+    std::vector<char> old_prefix(pagePrefix(page_schema), pagePrefix(page_schema) + old_prefix_size);
+    std::vector<char> new_prefix(prefix, prefix + prefix_size);
+    size_t old_step = page_schema.key_size + page_schema.value_size;
+    size_t step = old_step + old_prefix_size - prefix_size;
+    char *entries = page_schema.page_buffer + kOffsetOfPageHeader;
+    if (prefix_size < old_prefix_size)
+    {
+        for (size_t i = page_schema.size; i-- > 0;)
+        {
+            std::copy_backward(entries + i * old_step, entries + (i + 1) * old_step, entries + (i + 1) * step);
+            std::copy(old_prefix.begin() + prefix_size, old_prefix.end(), entries + i * step);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < page_schema.size; ++i)
+            std::copy(entries + i * old_step + prefix_size - old_prefix_size, entries + (i + 1) * old_step, entries + i * step);
+    }
+    page_schema.key_size = page_schema.key_size + old_prefix_size - prefix_size;
+    page_schema.index_size = page_schema.index_size + old_prefix_size - prefix_size;
+    page_schema.prefix_size = prefix_size;
+    page_schema.total_size = kOffsetOfPageHeader + page_schema.size * step;
+    std::copy(new_prefix.begin(), new_prefix.end(), page_schema.page_buffer + page_schema.page_size - prefix_size);
+    writeHeaderField(page_schema.page_buffer, kOffsetOfKeySize, page_schema.key_size);
+    writeHeaderField(page_schema.page_buffer, kOffsetOfIndexSize, page_schema.index_size);
+    writeHeaderField(page_schema.page_buffer, kOffsetOfPrefixSize, page_schema.prefix_size);
+}
+
+// Grows the prefix of a compressible leaf to everything its first and last
+// keys share, after a split or a merge has changed its entries.
+void compactPrefix(PageSchema &page_schema)
+{
+    if (!pageIsCompressible(page_schema) || page_schema.size == 0)
+        return;
+    size_t step = page_schema.key_size + page_schema.value_size;
+    const char *first = page_schema.page_buffer + kOffsetOfPageHeader;
+    const char *last = page_schema.page_buffer + page_schema.total_size - step;
+    size_t shared = std::mismatch(first, first + page_schema.index_size, last).first - first;
+    if (shared == 0)
+        return;
+    std::vector<char> prefix(page_schema.prefix_size + page_schema.key_size);
+    copyKey(page_schema, first, prefix.data());
+    setPagePrefix(page_schema, prefix.data(), page_schema.prefix_size + shared);
+}
+
+// Leaves of tables with VARCHAR columns are slotted: the entry array holds
+// each key with a slot, the offset and row size of its record, and records
+// grow down from the end of the page. A record is the key followed by the
+// row, so it reads like an entry of a fixed-width leaf. The heap is kept
+// dense; heap_size is -1 on every other page.
+bool pageIsSlotted(const PageHeader &page_schema)
+{
+    return page_schema.heap_size != -1;
+}
+
+char *slotRecord(const PageHeader &page_schema, const char *entry)
+{
+    uint32_t offset;
+    std::memcpy(&offset, entry + page_schema.key_size, sizeof(offset));
+    return page_schema.page_buffer + offset;
+}
+
+size_t slotSize(const PageHeader &page_schema, const char *entry)
+{
+    uint32_t size;
+    std::memcpy(&size, entry + page_schema.key_size + sizeof(uint32_t), sizeof(size));
+    return size;
+}
+
+void setHeapSize(PageSchema &page_schema, size_t heap_size)
+{
+    page_schema.heap_size = heap_size;
+    writeHeaderField(page_schema.page_buffer, kOffsetOfHeapSize, page_schema.heap_size);
+}
+
+// Stores the key already in entry and value as a new record.
+void appendRecord(PageSchema &page_schema, char *entry, const char *value, size_t value_size)
+{
+    setHeapSize(page_schema, page_schema.heap_size + page_schema.key_size + value_size);
+    uint32_t slot[2] = {static_cast<uint32_t>(page_schema.page_size - page_schema.heap_size), static_cast<uint32_t>(value_size)};
+    char *record = page_schema.page_buffer + slot[0];
+    std::copy(entry, entry + page_schema.key_size, record);
+    std::copy(value, value + value_size, record + page_schema.key_size);
+    std::memcpy(entry + page_schema.key_size, slot, kSizeOfSlot);
+}
+
+// Drops the record of entry, whose slot is still in the page, and moves the
+// records below it up.
+void removeRecord(PageSchema &page_schema, const char *entry)
+{
+    char *heap = page_schema.page_buffer + page_schema.page_size - page_schema.heap_size;
+    char *record = slotRecord(page_schema, entry);
+    size_t record_size = page_schema.key_size + slotSize(page_schema, entry);
+    std::copy_backward(heap, record, record + record_size);
+    for (size_t pos = kOffsetOfPageHeader; pos < page_schema.total_size; pos += page_schema.key_size + page_schema.value_size)
+    {
+        uint32_t offset;
+        std::memcpy(&offset, page_schema.page_buffer + pos + page_schema.key_size, sizeof(offset));
+        if (page_schema.page_buffer + offset < record)
+        {
+            offset += record_size;
+            std::memcpy(page_schema.page_buffer + pos + page_schema.key_size, &offset, sizeof(offset));
+        }
+    }
+    setHeapSize(page_schema, page_schema.heap_size - record_size);
+}
+
+// Rewrites the heap with only the records the entries still point to, after
+// a split or a range delete has dropped entries.
+void compactHeap(PageSchema &page_schema)
+{
+    size_t heap_offset = page_schema.page_size - page_schema.heap_size;
+    std::vector<char> heap(page_schema.page_buffer + heap_offset, page_schema.page_buffer + page_schema.page_size);
+    setHeapSize(page_schema, 0);
+    for (size_t pos = kOffsetOfPageHeader; pos < page_schema.total_size; pos += page_schema.key_size + page_schema.value_size)
+    {
+        char *entry = page_schema.page_buffer + pos;
+        size_t offset = slotRecord(page_schema, entry) - page_schema.page_buffer - heap_offset;
+        appendRecord(page_schema, entry, heap.data() + offset + page_schema.key_size, slotSize(page_schema, entry));
+    }
+}
+
+// Copies an entry of one leaf to new_entry of another with its full key, and
+// its row when the leaves are slotted.
+void transferEntry(const PageHeader &page_schema, const char *entry, PageSchema &new_page_schema, char *new_entry)
+{
+    if (!pageIsSlotted(page_schema))
+    {
+        copyEntry(page_schema, entry, new_entry);
+        return;
+    }
+    std::copy(entry, entry + page_schema.key_size, new_entry);
+    appendRecord(new_page_schema, new_entry, slotRecord(page_schema, entry) + page_schema.key_size, slotSize(page_schema, entry));
+}
+
+// Overflow pages hold the tail of a value too long for its row. A page of
+// the chain keeps its byte count in size and the next page in right_page_id,
+// and has no tree, so no search or hint ever takes it for a leaf.
+size_t writeOverflow(const char *data, size_t size)
+{
+    FileSystem &file_system = FileSystem::getInstance();
+    size_t capacity = file_system.pageSize() - kOffsetOfPageHeader;
+    size_t next_page_id = -1;
+    for (size_t end = size; end > 0;)
+    {
+        size_t begin = (end - 1) / capacity * capacity;
+        PageSchema page_schema(false, end - begin, -1, next_page_id, 0, 0, 0);
+        next_page_id = createNewPage(page_schema);
+        PagePtr page_ptr = BufferPool::getInstance().getPage(next_page_id);
+        std::copy(data + begin, data + end, page_ptr->buffer + kOffsetOfPageHeader);
+        file_system.write(next_page_id, page_ptr);
+        end = begin;
+    }
+    return next_page_id;
+}
+
+void readOverflow(size_t page_id, size_t size, char *data)
+{
+    for (size_t pos = 0; page_id != -1 && pos < size;)
+    {
+        const PageHeader &page_schema = getPageHandle(page_id, true)->header;
+        std::copy(page_schema.page_buffer + kOffsetOfPageHeader, page_schema.page_buffer + kOffsetOfPageHeader + page_schema.size, data + pos);
+        pos += page_schema.size;
+        page_id = page_schema.right_page_id;
+    }
+}
+
+void freeOverflow(size_t page_id)
+{
+    while (page_id != -1)
+    {
+        PageSchema page_schema = getPageSchema(page_id, true);
+        page_id = page_schema.right_page_id;
+        GDBE::getInstance().addFreePage(page_schema.page_id);
+    }
+}
+
+// Whether key can no longer be added without a split. A compressible leaf
+// is measured at the prefix it would keep with key in it, and a slotted leaf
+// by the bytes its entry and record would take.
+bool pageIsFull(const PageSchema &page_schema, const char *key, size_t value_size)
+{
+    if (pageIsSlotted(page_schema))
+        return page_schema.total_size + page_schema.heap_size + 2 * page_schema.key_size + page_schema.value_size + value_size > page_schema.page_size;
+    size_t prefix_size = prefixWith(page_schema, key);
+    size_t step = page_schema.key_size + page_schema.prefix_size - prefix_size + page_schema.value_size;
+    return (page_schema.page_size - kOffsetOfPageHeader - prefix_size) / step <= page_schema.size;
+}
+
+// Measured at full key width, so a minimum leaf can always take its
+// neighbour's entries with the prefix dropped. dataOverFlow keeps every entry
+// of a slotted leaf under a third of the page, so a slotted leaf that is
+// minimum can take one more entry or be merged with a minimum neighbour, and
+// a leaf with one entry never lends it.
 bool pageIsMinimum(const PageSchema &page_schema)
 {
-    return kOffsetOfPageHeader + (2 * page_schema.size + 1) * (page_schema.key_size + page_schema.value_size) < kPageSize;
+    if (pageIsSlotted(page_schema))
+        return page_schema.size < 2 || kOffsetOfPageHeader + 2 * (page_schema.total_size - kOffsetOfPageHeader + page_schema.heap_size) + (page_schema.page_size - kOffsetOfPageHeader) / 3 < page_schema.page_size;
+    return kOffsetOfPageHeader + (2 * page_schema.size + 1) * (page_schema.key_size + page_schema.prefix_size + page_schema.value_size) < page_schema.page_size;
 }
 
 bool dataOverFlow(size_t key_size, size_t value_size)
 {
-    return (kPageSize - kOffsetOfPageHeader) / (key_size + value_size) < 3;
+    return (FileSystem::getInstance().pageSize() - kOffsetOfPageHeader) / (key_size + value_size) < 3;
 }
 
-PageSchema getPageSchema(size_t page_id)
+Page *getPageHandle(size_t page_id, bool scan)
 {
-    BufferPool &buffer_pool = BufferPool::getInstance();
+    Page *page = BufferPool::getInstance().fetchPage(page_id, scan);
+    if (!page->header_valid)
+        decodePageHeader(page);
+    return page;
+}
+
+void decodePageHeader(Page *page)
+{
+    PageHeader &header = page->header;
+    header.page_buffer = page->buffer;
+    header.leaf = readHeaderField(header.page_buffer, kOffsetOfLeaf);
+    header.size = readHeaderField(header.page_buffer, kOffsetOfSize);
+    header.left_page_id = readHeaderField(header.page_buffer, kOffsetOfLeftPageId);
+    header.right_page_id = readHeaderField(header.page_buffer, kOffsetOfRightPageId);
+    header.key_size = readHeaderField(header.page_buffer, kOffsetOfKeySize);
+    header.index_size = readHeaderField(header.page_buffer, kOffsetOfIndexSize);
+    header.value_size = readHeaderField(header.page_buffer, kOffsetOfValueSize);
+    header.tree_id = readHeaderField(header.page_buffer, kOffsetOfTreeId);
+    header.prefix_size = readHeaderField(header.page_buffer, kOffsetOfPrefixSize);
+    header.heap_size = readHeaderField(header.page_buffer, kOffsetOfHeapSize);
+    header.total_size = kOffsetOfPageHeader + header.size * (header.key_size + header.value_size);
+    header.page_id = page->page_id;
+    header.page_size = page->page_size;
+    page->header_valid = true;
+}
+
+PageSchema getPageSchema(size_t page_id, bool scan)
+{
+    Page *page = getPageHandle(page_id, scan);
     PageSchema page_schema;
-    page_schema.page_ptr = buffer_pool.getPage(page_id);
-    page_schema.page_buffer = page_schema.page_ptr->buffer;
-    page_schema.leaf = *reinterpret_cast<const bool *>(page_schema.page_buffer + kOffsetOfLeaf);
-    page_schema.size = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfSize);
-    page_schema.left_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfLeftPageId);
-    page_schema.right_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfRightPageId);
-    page_schema.key_size = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfKeySize);
-    page_schema.index_size = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfIndexSize);
-    page_schema.value_size = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfValueSize);
-    page_schema.cmp = *reinterpret_cast<const bool *>(page_schema.page_buffer + kOffsetOfCompareType);
-    page_schema.compare = page_schema.cmp ? compareInt : compareString;
-    page_schema.total_size = kOffsetOfPageHeader + page_schema.size * (page_schema.key_size + page_schema.value_size);
-    page_schema.page_id = page_id;
+    static_cast<PageHeader &>(page_schema) = page->header;
+    page_schema.page_ptr = PagePtr(page);
     return page_schema;
 }
 
-size_t BPlusTreeInsert(size_t page_id, char *key, char *value, bool unique, size_t *root_page_id)
+// value_size is the size of a row bound for a slotted leaf; other leaves take
+// values of the width in their header.
+size_t BPlusTreeInsert(size_t page_id, char *key, char *value, bool unique, size_t *root_page_id, size_t value_size)
 {
     FileSystem &file_system = FileSystem::getInstance();
     PageSchema page_schema = getPageSchema(page_id);
-    if (pageIsFull(page_schema))
+    if (pageIsFull(page_schema, key, value_size))
     {
-        PageSchema new_page_schema(false, 0, -1, -1, page_schema.key_size, page_schema.index_size, kSizeOfSizeT, page_schema.cmp);
-        char *left_key = page_schema.page_buffer + kOffsetOfPageHeader;
-        char *middle_key = new char[page_schema.key_size];
-        size_t right_child_page_id = splitFullPage(page_id, middle_key);
+        PageSchema new_page_schema(false, 0, -1, -1, page_schema.key_size + page_schema.prefix_size, page_schema.index_size + page_schema.prefix_size, kSizeOfSizeT, page_schema.tree_id);
+        char *left_key = new char[new_page_schema.key_size];
+        copyKey(page_schema, page_schema.page_buffer + kOffsetOfPageHeader, left_key);
+        char *middle_key = new char[new_page_schema.key_size];
+        size_t right_child_page_id = splitFullPage(page_id, middle_key, key, value_size);
         size_t new_page_id = createNewPage(new_page_schema);
         new_page_schema = getPageSchema(new_page_id);
-        std::copy(left_key, left_key + page_schema.key_size, new_page_schema.page_buffer + kOffsetOfPageHeader);
+        std::copy(left_key, left_key + new_page_schema.key_size, new_page_schema.page_buffer + kOffsetOfPageHeader);
         std::copy(reinterpret_cast<const char *>(&page_schema.page_id), reinterpret_cast<const char *>(&page_schema.page_id) + kSizeOfSizeT, new_page_schema.page_buffer + kOffsetOfPageHeader + new_page_schema.key_size);
-        std::copy(middle_key, middle_key + page_schema.key_size, new_page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size + kSizeOfSizeT);
+        std::copy(middle_key, middle_key + new_page_schema.key_size, new_page_schema.page_buffer + kOffsetOfPageHeader + new_page_schema.key_size + kSizeOfSizeT);
         std::copy(reinterpret_cast<const char *>(&right_child_page_id), reinterpret_cast<const char *>(&right_child_page_id) + kSizeOfSizeT, new_page_schema.page_buffer + kOffsetOfPageHeader + kSizeOfSizeT + new_page_schema.key_size * 2);
         new_page_schema.size += 2;
-        std::copy(reinterpret_cast<const char *>(&new_page_schema.size), reinterpret_cast<const char *>(&new_page_schema.size) + kSizeOfSizeT, new_page_schema.page_buffer + kOffsetOfSize);
+        writeHeaderField(new_page_schema.page_buffer, kOffsetOfSize, new_page_schema.size);
         *root_page_id = new_page_id;
         page_id = new_page_id;
         file_system.write(page_id, new_page_schema.page_ptr);
+        delete[] left_key;
+        delete[] middle_key;
     }
-    return insertNonFullPage(page_id, key, value, unique);
+    return insertNonFullPage(page_id, key, value, unique, value_size);
 }
 
 size_t createNewPage(const PageSchema &page_schema)
@@ -69,35 +441,44 @@ size_t createNewPage(const PageSchema &page_schema)
     FileSystem &file_system = FileSystem::getInstance();
     PagePtr page_ptr = buffer_pool.getPage(new_page_id);
     char *new_page_buffer = page_ptr->buffer;
-    std::copy(reinterpret_cast<const char *>(&page_schema.leaf), reinterpret_cast<const char *>(&page_schema.leaf) + kSizeOfBool, new_page_buffer + kOffsetOfLeaf);
-    std::copy(reinterpret_cast<const char *>(&page_schema.size), reinterpret_cast<const char *>(&page_schema.size) + kSizeOfSizeT, new_page_buffer + kOffsetOfSize);
-    std::copy(reinterpret_cast<const char *>(&page_schema.left_page_id), reinterpret_cast<const char *>(&page_schema.left_page_id) + kSizeOfSizeT, new_page_buffer + kOffsetOfLeftPageId);
-    std::copy(reinterpret_cast<const char *>(&page_schema.right_page_id), reinterpret_cast<const char *>(&page_schema.right_page_id) + kSizeOfSizeT, new_page_buffer + kOffsetOfRightPageId);
-    std::copy(reinterpret_cast<const char *>(&page_schema.key_size), reinterpret_cast<const char *>(&page_schema.key_size) + kSizeOfSizeT, new_page_buffer + kOffsetOfKeySize);
-    std::copy(reinterpret_cast<const char *>(&page_schema.index_size), reinterpret_cast<const char *>(&page_schema.index_size) + kSizeOfSizeT, new_page_buffer + kOffsetOfIndexSize);
-    std::copy(reinterpret_cast<const char *>(&page_schema.value_size), reinterpret_cast<const char *>(&page_schema.value_size) + kSizeOfSizeT, new_page_buffer + kOffsetOfValueSize);
-    std::copy(reinterpret_cast<const char *>(&page_schema.cmp), reinterpret_cast<const char *>(&page_schema.cmp) + kSizeOfBool, new_page_buffer + kOffsetOfCompareType);
+    writeHeaderField(new_page_buffer, kOffsetOfLeaf, page_schema.leaf);
+    writeHeaderField(new_page_buffer, kOffsetOfSize, page_schema.size);
+    writeHeaderField(new_page_buffer, kOffsetOfLeftPageId, page_schema.left_page_id);
+    writeHeaderField(new_page_buffer, kOffsetOfRightPageId, page_schema.right_page_id);
+    writeHeaderField(new_page_buffer, kOffsetOfKeySize, page_schema.key_size);
+    writeHeaderField(new_page_buffer, kOffsetOfIndexSize, page_schema.index_size);
+    writeHeaderField(new_page_buffer, kOffsetOfValueSize, page_schema.value_size);
+    writeHeaderField(new_page_buffer, kOffsetOfTreeId, page_schema.tree_id);
+    writeHeaderField(new_page_buffer, kOffsetOfPrefixSize, page_schema.prefix_size);
+    writeHeaderField(new_page_buffer, kOffsetOfHeapSize, page_schema.heap_size);
     file_system.write(new_page_id, page_ptr);
     return new_page_id;
 }
 
-size_t insertNonFullPage(size_t page_id, char *key, char *value, bool unique)
+size_t insertNonFullPage(size_t page_id, char *key, char *value, bool unique, size_t value_size)
 {
     FileSystem &file_system = FileSystem::getInstance();
     PageSchema page_schema = getPageSchema(page_id);
     bool null = true;
-    size_t pos = kOffsetOfPageHeader;
-    while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, page_schema.key_size) >= 0)
-        pos += page_schema.key_size + page_schema.value_size;
+    if (page_schema.leaf && (prefixWith(page_schema, key) != page_schema.prefix_size || (page_schema.size == 0 && page_schema.prefix_size)))
+    {
+        setPagePrefix(page_schema, key, prefixWith(page_schema, key));
+        file_system.write(page_id, page_schema.page_ptr);
+    }
+    size_t pos = upperBoundInPage(page_schema, kOffsetOfPageHeader, key, page_schema.key_size);
     if (page_schema.leaf)
     {
-        if (unique && pos > kOffsetOfPageHeader && page_schema.compare(key, page_schema.page_buffer + pos - page_schema.key_size - page_schema.value_size, page_schema.index_size) == 0)
+        if (unique && pos > kOffsetOfPageHeader && compareEntry(page_schema, key, page_schema.page_buffer + pos - page_schema.key_size - page_schema.value_size, page_schema.index_size) == 0)
             return -1;
         std::copy_backward(page_schema.page_buffer + pos, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + page_schema.total_size + page_schema.key_size + page_schema.value_size);
-        std::copy(key, key + page_schema.key_size, page_schema.page_buffer + pos);
-        std::copy(value, value + page_schema.value_size, page_schema.page_buffer + pos + page_schema.key_size);
+        std::copy(key + page_schema.prefix_size, key + page_schema.prefix_size + page_schema.key_size, page_schema.page_buffer + pos);
+        page_schema.total_size += page_schema.key_size + page_schema.value_size;
+        if (pageIsSlotted(page_schema))
+            appendRecord(page_schema, page_schema.page_buffer + pos, value, value_size);
+        else
+            std::copy(value, value + page_schema.value_size, page_schema.page_buffer + pos + page_schema.key_size);
         ++page_schema.size;
-        std::copy(reinterpret_cast<const char *>(&page_schema.size), reinterpret_cast<const char *>(&page_schema.size) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfSize);
+        writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
         file_system.write(page_id, page_schema.page_ptr);
         return page_id;
     }
@@ -113,65 +494,128 @@ size_t insertNonFullPage(size_t page_id, char *key, char *value, bool unique)
         size_t child_page_id = -1;
         child_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + pos - page_schema.value_size);
         PageSchema child_page_schema = getPageSchema(child_page_id);
-        if (pageIsFull(child_page_schema))
+        if (pageIsFull(child_page_schema, key, value_size))
         {
-            char *middle_key = new char[child_page_schema.key_size];
-            size_t right_child_page_id = splitFullPage(child_page_id, middle_key);
+            char *middle_key = new char[page_schema.key_size];
+            size_t right_child_page_id = splitFullPage(child_page_id, middle_key, key, value_size);
             std::copy_backward(page_schema.page_buffer + pos, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + page_schema.total_size + page_schema.key_size + page_schema.value_size);
             std::copy(middle_key, middle_key + page_schema.key_size, page_schema.page_buffer + pos);
             std::copy(reinterpret_cast<const char *>(&child_page_id), reinterpret_cast<const char *>(&child_page_id) + kSizeOfSizeT, page_schema.page_buffer + pos - page_schema.value_size);
             std::copy(reinterpret_cast<const char *>(&right_child_page_id), reinterpret_cast<const char *>(&right_child_page_id) + kSizeOfSizeT, page_schema.page_buffer + pos + page_schema.key_size);
             ++page_schema.size;
-            std::copy(reinterpret_cast<const char *>(&page_schema.size), reinterpret_cast<const char *>(&page_schema.size) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfSize);
+            writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
             file_system.write(page_id, page_schema.page_ptr);
-            if (page_schema.compare(key, middle_key, page_schema.key_size) < 0)
-                return insertNonFullPage(child_page_id, key, value, unique);
+            bool left = std::memcmp(key, middle_key, page_schema.key_size) < 0;
+            delete[] middle_key;
+            if (left)
+                return insertNonFullPage(child_page_id, key, value, unique, value_size);
             else
-                return insertNonFullPage(right_child_page_id, key, value, unique);
+                return insertNonFullPage(right_child_page_id, key, value, unique, value_size);
         }
         else
         {
-            return insertNonFullPage(child_page_id, key, value, unique);
+            return insertNonFullPage(child_page_id, key, value, unique, value_size);
         }
     }
 }
 
-size_t splitFullPage(size_t page_id, char *middle_key)
+// Where to split a full slotted leaf so that neither half, with the entry
+// for key added to it, holds more bytes than the other needs to. Both halves
+// keep an entry, and with every entry under a third of the page both fit.
+size_t slottedMiddle(const PageSchema &page_schema, const char *key, size_t value_size)
+{
+    size_t step = page_schema.key_size + page_schema.value_size;
+    size_t key_pos = (upperBoundInPage(page_schema, kOffsetOfPageHeader, key, page_schema.key_size) - kOffsetOfPageHeader) / step;
+    size_t key_bytes = step + page_schema.key_size + value_size;
+    size_t total_bytes = page_schema.total_size - kOffsetOfPageHeader + page_schema.heap_size + key_bytes;
+    size_t middle = 1, best = -1, left_bytes = 0;
+    for (size_t i = 1; i < page_schema.size; ++i)
+    {
+        left_bytes += step + page_schema.key_size + slotSize(page_schema, page_schema.page_buffer + kOffsetOfPageHeader + (i - 1) * step);
+        size_t bytes = left_bytes + (key_pos <= i ? key_bytes : 0);
+        size_t larger = std::max(bytes, total_bytes - bytes);
+        if (larger < best)
+        {
+            best = larger;
+            middle = i;
+        }
+    }
+    return middle;
+}
+
+// Splits a page that cannot take key. When key would shorten the prefix of a
+// compressible leaf, it sorts before or after every entry, and the split is
+// made there so that it starts a page of its own.
+size_t splitFullPage(size_t page_id, char *middle_key, const char *key, size_t value_size)
 {
     FileSystem &file_system = FileSystem::getInstance();
     PageSchema page_schema = getPageSchema(page_id);
+    size_t step = page_schema.key_size + page_schema.value_size;
     size_t middle = page_schema.size / 2;
-    size_t pos = kOffsetOfPageHeader + middle * (page_schema.key_size + page_schema.value_size);
-    std::copy(page_schema.page_buffer + pos, page_schema.page_buffer + pos + page_schema.key_size, middle_key);
-    PageSchema new_right_page_schema(page_schema.leaf, page_schema.size - middle, page_schema.page_id, page_schema.right_page_id, page_schema.key_size, page_schema.index_size, page_schema.value_size, page_schema.cmp);
+    if (pageIsCompressible(page_schema) && prefixWith(page_schema, key) < page_schema.prefix_size)
+        middle = (upperBoundInPage(page_schema, kOffsetOfPageHeader, key, page_schema.key_size) - kOffsetOfPageHeader) / step;
+    else if (pageIsSlotted(page_schema))
+        middle = slottedMiddle(page_schema, key, value_size);
+    size_t pos = kOffsetOfPageHeader + middle * step;
+    if (middle < page_schema.size)
+        copyKey(page_schema, page_schema.page_buffer + pos, middle_key);
+    else
+        std::copy(key, key + page_schema.prefix_size + page_schema.key_size, middle_key);
+    PageSchema new_right_page_schema(page_schema.leaf, page_schema.size - middle, page_schema.page_id, page_schema.right_page_id, page_schema.key_size, page_schema.index_size, page_schema.value_size, page_schema.tree_id);
+    new_right_page_schema.prefix_size = page_schema.prefix_size;
+    new_right_page_schema.heap_size = pageIsSlotted(page_schema) ? 0 : -1;
     size_t new_right_page_id = createNewPage(new_right_page_schema);
     new_right_page_schema = getPageSchema(new_right_page_id);
     std::copy(page_schema.page_buffer + pos, page_schema.page_buffer + page_schema.total_size, new_right_page_schema.page_buffer + kOffsetOfPageHeader);
-    std::copy(reinterpret_cast<const char *>(&middle), reinterpret_cast<const char *>(&middle) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfSize);
-    std::copy(reinterpret_cast<const char *>(&new_right_page_id), reinterpret_cast<const char *>(&new_right_page_id) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfRightPageId);
+    std::copy(pagePrefix(page_schema), pagePrefix(page_schema) + page_schema.prefix_size, new_right_page_schema.page_buffer + new_right_page_schema.page_size - page_schema.prefix_size);
+    writeHeaderField(page_schema.page_buffer, kOffsetOfSize, middle);
+    writeHeaderField(page_schema.page_buffer, kOffsetOfRightPageId, new_right_page_id);
+    if (pageIsSlotted(page_schema))
+    {
+        for (size_t new_pos = kOffsetOfPageHeader; new_pos < new_right_page_schema.total_size; new_pos += step)
+            transferEntry(page_schema, page_schema.page_buffer + pos + new_pos - kOffsetOfPageHeader, new_right_page_schema, new_right_page_schema.page_buffer + new_pos);
+    }
+    page_schema.size = middle;
+    page_schema.total_size = pos;
+    compactPrefix(page_schema);
+    compactPrefix(new_right_page_schema);
+    if (pageIsSlotted(page_schema))
+        compactHeap(page_schema);
     file_system.write(page_id, page_schema.page_ptr);
     file_system.write(new_right_page_id, new_right_page_schema.page_ptr);
     return new_right_page_id;
 }
 
-char *BPlusTreeSearch(size_t page_id, char *key, bool is_index)
+RecordPtr makeRecordPtr(Page *page, const PageHeader &page_schema, char *entry)
 {
-    PageSchema page_schema = getPageSchema(page_id);
-    size_t pos = kOffsetOfPageHeader;
+    if (pageIsSlotted(page_schema))
+        return RecordPtr(PagePtr(page), slotRecord(page_schema, entry));
+    if (page_schema.prefix_size == 0)
+        return RecordPtr(PagePtr(page), entry);
+    std::shared_ptr<std::vector<char>> buffer = std::make_shared<std::vector<char>>(page_schema.prefix_size + page_schema.key_size + page_schema.value_size);
+    copyEntry(page_schema, entry, buffer->data());
+    RecordPtr record_ptr(PagePtr(page), buffer->data());
+    record_ptr.buffer = std::move(buffer);
+    return record_ptr;
+}
+
+RecordPtr BPlusTreeSearch(size_t page_id, char *key, bool is_index)
+{
+    Page *page = getPageHandle(page_id);
+    const PageHeader &page_schema = page->header;
     size_t compare_size = is_index ? page_schema.index_size : page_schema.key_size;
-    while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, compare_size) >= 0)
-        pos += page_schema.key_size + page_schema.value_size;
+    size_t pos = upperBoundInPage(page_schema, kOffsetOfPageHeader, key, compare_size);
     if (page_schema.leaf)
     {
-        if (pos > kOffsetOfPageHeader && page_schema.compare(key, page_schema.page_buffer + pos - page_schema.key_size - page_schema.value_size, compare_size) == 0)
-            return page_schema.page_buffer + pos - page_schema.key_size - page_schema.value_size;
+        if (pos > kOffsetOfPageHeader && compareEntry(page_schema, key, page_schema.page_buffer + pos - page_schema.key_size - page_schema.value_size, compare_size) == 0)
+            return makeRecordPtr(page, page_schema, page_schema.page_buffer + pos - page_schema.key_size - page_schema.value_size);
         else
-            return nullptr;
+            return RecordPtr();
     }
     else
     {
         if (pos == kOffsetOfPageHeader)
-            return nullptr;
+            return RecordPtr();
         else
         {
             size_t child_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + pos - page_schema.value_size);
@@ -180,6 +624,141 @@ char *BPlusTreeSearch(size_t page_id, char *key, bool is_index)
     }
 }
 
+// Overwrites the value of the entry for key where it lies. Only values kept
+// in the entry itself can be written so, not those of a slotted leaf.
+bool BPlusTreeUpdate(size_t page_id, char *key, const char *value)
+{
+    PageSchema page_schema = getPageSchema(page_id);
+    size_t step = page_schema.key_size + page_schema.value_size;
+    size_t pos = upperBoundInPage(page_schema, kOffsetOfPageHeader, key, page_schema.key_size);
+    if (!page_schema.leaf)
+        return pos != kOffsetOfPageHeader && BPlusTreeUpdate(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos - page_schema.value_size), key, value);
+    if (pageIsSlotted(page_schema) || pos == kOffsetOfPageHeader || compareEntry(page_schema, key, page_schema.page_buffer + pos - step, page_schema.key_size) != 0)
+        return false;
+    std::copy(value, value + page_schema.value_size, page_schema.page_buffer + pos - page_schema.value_size);
+    FileSystem::getInstance().write(page_id, page_schema.page_ptr);
+    return true;
+}
+
+// Looks up key in the leaf a secondary index remembered for its row. The page
+// may have been split, merged, freed or handed to another tree since, so the
+// hint only counts while it is still a leaf of tree_id and not on the free
+// list, as a freed page keeps its bytes until it is reused. A split moves the
+// upper half of a leaf to its new right sibling, so a key past the end of the
+// hinted leaf is followed up to kHintRightHops pages to the right.
+RecordPtr BPlusTreeHintSearch(size_t page_id, size_t tree_id, char *key)
+{
+    if (tree_id == 0)
+        return RecordPtr();
+    GDBE &gdbe = GDBE::getInstance();
+    for (size_t hop = 0; hop <= kHintRightHops && page_id != -1; ++hop)
+    {
+        if (gdbe.isFreePage(page_id))
+            return RecordPtr();
+        Page *page = getPageHandle(page_id);
+        const PageHeader &page_schema = page->header;
+        if (!page_schema.leaf || page_schema.tree_id != tree_id || page_schema.size == 0)
+            return RecordPtr();
+        size_t step = page_schema.key_size + page_schema.value_size;
+        if (compareEntry(page_schema, key, page_schema.page_buffer + page_schema.total_size - step, page_schema.key_size) > 0)
+        {
+            page_id = page_schema.right_page_id;
+            continue;
+        }
+        size_t pos = lowerBoundInPage(page_schema, kOffsetOfPageHeader, key, page_schema.key_size);
+        if (compareEntry(page_schema, key, page_schema.page_buffer + pos, page_schema.key_size) == 0)
+            return makeRecordPtr(page, page_schema, page_schema.page_buffer + pos);
+        return RecordPtr();
+    }
+    return RecordPtr();
+}
+
+// Looks up every key of key_vector with one descent: keys are visited in tree
+// order, each internal page is read once per batch and routes a run of keys
+// to a child, and a leaf is walked forward for all the keys it holds. The
+// result is in key_vector order, with an empty RecordPtr for a missing key.
+// With hint_vector, each key first tries its hinted leaf and only the misses
+// descend.
+std::vector<RecordPtr> BPlusTreeMultiSearch(size_t page_id, const std::vector<char *> &key_vector, bool is_index, const std::vector<size_t> *hint_vector)
+{
+    std::vector<RecordPtr> record_vector(key_vector.size());
+    if (key_vector.empty())
+        return record_vector;
+    const PageHeader &page_schema = getPageHandle(page_id)->header;
+    size_t compare_size = (is_index ? page_schema.index_size : page_schema.key_size) + page_schema.prefix_size;
+    std::vector<size_t> order_vector;
+    if (hint_vector && page_schema.tree_id != 0)
+    {
+        size_t tree_id = page_schema.tree_id;
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        for (size_t i = 0; i < key_vector.size(); ++i)
+        {
+            if (i % kReadAheadSize == 0)
+                buffer_pool.readAhead(std::vector<size_t>(hint_vector->begin() + i, hint_vector->begin() + std::min(i + kReadAheadSize, hint_vector->size())));
+            record_vector[i] = BPlusTreeHintSearch((*hint_vector)[i], tree_id, key_vector[i]);
+            if (!record_vector[i])
+                order_vector.push_back(i);
+        }
+        if (order_vector.empty())
+            return record_vector;
+    }
+    else
+    {
+        order_vector.resize(key_vector.size());
+        for (size_t i = 0; i < order_vector.size(); ++i)
+            order_vector[i] = i;
+    }
+    std::stable_sort(order_vector.begin(), order_vector.end(), [&](size_t lhs, size_t rhs) { return std::memcmp(key_vector[lhs], key_vector[rhs], compare_size) < 0; });
+    multiSearchPage(page_id, key_vector, order_vector, 0, order_vector.size(), is_index, &record_vector);
+    return record_vector;
+}
+
+void multiSearchPage(size_t page_id, const std::vector<char *> &key_vector, const std::vector<size_t> &order_vector, size_t begin, size_t end, bool is_index, std::vector<RecordPtr> *record_vector)
+{
+    Page *page = getPageHandle(page_id);
+    PagePtr page_ptr(page);
+    const PageHeader page_schema = page->header;
+    size_t step = page_schema.key_size + page_schema.value_size;
+    size_t compare_size = is_index ? page_schema.index_size : page_schema.key_size;
+    size_t pos = kOffsetOfPageHeader;
+    if (page_schema.leaf)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            char *key = key_vector[order_vector[i]];
+            pos = upperBoundInPage(page_schema, pos, key, compare_size);
+            if (pos > kOffsetOfPageHeader && compareEntry(page_schema, key, page_schema.page_buffer + pos - step, compare_size) == 0)
+                (*record_vector)[order_vector[i]] = makeRecordPtr(page, page_schema, page_schema.page_buffer + pos - step);
+        }
+        return;
+    }
+    std::vector<std::pair<size_t, size_t>> child_vector;
+    std::vector<size_t> child_page_id_vector;
+    for (size_t i = begin; i < end;)
+    {
+        char *key = key_vector[order_vector[i]];
+        pos = upperBoundInPage(page_schema, pos, key, compare_size);
+        if (pos == kOffsetOfPageHeader)
+        {
+            ++i;
+            continue;
+        }
+        size_t j = i + 1;
+        while (j < end && (pos >= page_schema.total_size || std::memcmp(key_vector[order_vector[j]], page_schema.page_buffer + pos, compare_size) < 0))
+            ++j;
+        child_vector.push_back({i, j});
+        child_page_id_vector.push_back(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos - page_schema.value_size));
+        i = j;
+    }
+    BufferPool &buffer_pool = BufferPool::getInstance();
+    for (size_t i = 0; i < child_vector.size(); ++i)
+    {
+        if (i % (kReadAheadSize / 2) == 0 && child_vector.size() > 1)
+            buffer_pool.readAhead(std::vector<size_t>(child_page_id_vector.begin() + i, child_page_id_vector.begin() + std::min(i + kReadAheadSize, child_page_id_vector.size())));
+        multiSearchPage(child_page_id_vector[i], key_vector, order_vector, child_vector[i].first, child_vector[i].second, is_index, record_vector);
+    }
+}
+
 Iterator BPlusTreeSelect(size_t page_id, char *begin_key, char *end_key, bool is_index)
 {
     int left = 0, right = 0;
@@ -191,14 +770,14 @@ Iterator BPlusTreeSelect(size_t page_id, char *begin_key, char *end_key, bool is
     size_t end_pos = kOffsetOfPageHeader;
     size_t begin_id = BPlusTreeTraverse(page_id, begin_key, false, left, is_index, &begin_pos);
     size_t end_id = BPlusTreeTraverse(page_id, end_key, true, right, is_index, &end_pos);
-    return Iterator({begin_id, begin_pos}, {end_id, end_pos});
+    return Iterator({begin_id, begin_pos}, {end_id, end_pos}, page_id);
 }
 
 size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is_index, size_t *pos_ptr)
 {
     if (page_id == -1 || side == 1)
         return -1;
-    PageSchema page_schema = getPageSchema(page_id);
+    const PageHeader &page_schema = getPageHandle(page_id)->header;
     size_t compare_size = is_index ? page_schema.index_size : page_schema.key_size;
     size_t pos = kOffsetOfPageHeader;
     if (page_schema.size == 0)
@@ -211,8 +790,7 @@ size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is
                 return page_id;
             if (next)
             {
-                while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, compare_size) >= 0)
-                    pos += page_schema.key_size + page_schema.value_size;
+                pos = upperBoundInPage(page_schema, pos, key, compare_size);
                 if (pos >= page_schema.total_size)
                     return BPlusTreeTraverse(page_schema.right_page_id, key, next, side, is_index, pos_ptr);
                 else
@@ -223,8 +801,7 @@ size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is
             }
             else
             {
-                while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, compare_size) > 0)
-                    pos += page_schema.key_size + page_schema.value_size;
+                pos = lowerBoundInPage(page_schema, pos, key, compare_size);
                 if (pos >= page_schema.total_size)
                     return BPlusTreeTraverse(page_schema.right_page_id, key, next, side, is_index, pos_ptr);
                 else
@@ -240,8 +817,7 @@ size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is
                 return BPlusTreeTraverse(*reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size), key, next, side, is_index, pos_ptr);
             if (next)
             {
-                while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, compare_size) >= 0)
-                    pos += page_schema.value_size + page_schema.key_size;
+                pos = upperBoundInPage(page_schema, pos, key, compare_size);
                 if (pos == kOffsetOfPageHeader)
                     return BPlusTreeTraverse(*reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size), key, next, side, is_index, pos_ptr);
                 else
@@ -249,11 +825,10 @@ size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is
             }
             else
             {
-                while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, compare_size) > 0)
-                    pos += page_schema.value_size + page_schema.key_size;
+                pos = lowerBoundInPage(page_schema, pos, key, compare_size);
                 if (pos == page_schema.total_size)
                     return BPlusTreeTraverse(*reinterpret_cast<const size_t *>(page_schema.page_buffer + page_schema.total_size - page_schema.value_size), key, next, side, is_index, pos_ptr);
-                else if (page_schema.compare(key, page_schema.page_buffer + pos, compare_size) == 0)
+                else if (std::memcmp(key, page_schema.page_buffer + pos, compare_size) == 0 && (compare_size == page_schema.key_size || pos == kOffsetOfPageHeader))
                     return BPlusTreeTraverse(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos + page_schema.key_size), key, next, side, is_index, pos_ptr);
                 else if (pos == kOffsetOfPageHeader)
                     return BPlusTreeTraverse(*reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size), key, next, side, is_index, pos_ptr);
@@ -265,23 +840,75 @@ size_t BPlusTreeTraverse(size_t page_id, char *key, bool next, int side, bool is
 }
 
 void BPlusTreeRemove(size_t page_id)
+{
+    if (page_id == -1)
+        return;
+    size_t first_leaf_page_id = -1, last_leaf_page_id = -1;
+    removeSubTree(page_id, getTreeLevel(page_id), &first_leaf_page_id, &last_leaf_page_id);
+}
+
+size_t getTreeLevel(size_t page_id)
+{
+    size_t level = 0;
+    const PageHeader *page_header = &getPageHandle(page_id)->header;
+    while (!page_header->leaf)
+    {
+        page_header = &getPageHandle(*reinterpret_cast<const size_t *>(page_header->page_buffer + kOffsetOfPageHeader + page_header->key_size))->header;
+        ++level;
+    }
+    return level;
+}
+
+void BPlusTreeLeafRun(size_t page_id, size_t level, char *key, size_t count, std::vector<size_t> *leaf_vector)
+{
+    if (level == 0)
+    {
+        if (count)
+            leaf_vector->push_back(page_id);
+        return;
+    }
+    const PageHeader &page_schema = getPageHandle(page_id)->header;
+    size_t step = page_schema.key_size + page_schema.value_size;
+    size_t pos = upperBoundInPage(page_schema, kOffsetOfPageHeader, key, page_schema.key_size);
+    if (pos > kOffsetOfPageHeader)
+        pos -= step;
+    if (level > 1)
+    {
+        BPlusTreeLeafRun(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos + page_schema.key_size), level - 1, key, count, leaf_vector);
+        return;
+    }
+    for (; pos < page_schema.total_size && count; pos += step, --count)
+        leaf_vector->push_back(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos + page_schema.key_size));
+}
+
+void removeSubTree(size_t page_id, size_t level, size_t *first_leaf_page_id_ptr, size_t *last_leaf_page_id_ptr)
 {
     GDBE &gdbe = GDBE::getInstance();
-    PageSchema page_schema = getPageSchema(page_id);
-    size_t child_page_id = -1;
-    if (!page_schema.leaf)
-        child_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size);
-    size_t right_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfRightPageId);
-    gdbe.addFreePage(page_id);
-    while (right_page_id != -1)
+    if (level == 0)
     {
-        page_id = right_page_id;
-        page_schema = getPageSchema(page_id);
-        right_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfRightPageId);
+        if (*first_leaf_page_id_ptr == -1)
+            *first_leaf_page_id_ptr = page_id;
+        *last_leaf_page_id_ptr = page_id;
         gdbe.addFreePage(page_id);
+        return;
     }
-    if (child_page_id != -1)
-        return BPlusTreeRemove(child_page_id);
+    PageSchema page_schema = getPageSchema(page_id);
+    for (size_t pos = kOffsetOfPageHeader; pos < page_schema.total_size; pos += page_schema.key_size + page_schema.value_size)
+        removeSubTree(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos + page_schema.key_size), level - 1, first_leaf_page_id_ptr, last_leaf_page_id_ptr);
+    gdbe.addFreePage(page_id);
+}
+
+size_t BPlusTreeTruncate(size_t page_id)
+{
+    size_t level = getTreeLevel(page_id);
+    PageSchema page_schema = getPageSchema(page_id);
+    while (!page_schema.leaf)
+        page_schema = getPageSchema(*reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size));
+    PageSchema new_page_schema(true, 0, -1, -1, page_schema.key_size + page_schema.prefix_size, page_schema.index_size + page_schema.prefix_size, page_schema.value_size, page_schema.tree_id);
+    new_page_schema.heap_size = pageIsSlotted(page_schema) ? 0 : -1;
+    size_t first_leaf_page_id = -1, last_leaf_page_id = -1;
+    removeSubTree(page_id, level, &first_leaf_page_id, &last_leaf_page_id);
+    return createNewPage(new_page_schema);
 }
 
 void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
@@ -291,21 +918,22 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
     size_t pos = kOffsetOfPageHeader;
     if (page_schema.size == 0)
         return;
-    while (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, page_schema.key_size) > 0)
-        pos += page_schema.value_size + page_schema.key_size;
+    pos = lowerBoundInPage(page_schema, pos, key, page_schema.key_size);
     if (page_schema.leaf)
     {
-        if (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, page_schema.key_size) == 0)
+        if (pos < page_schema.total_size && compareEntry(page_schema, key, page_schema.page_buffer + pos, page_schema.key_size) == 0)
         {
+            if (pageIsSlotted(page_schema))
+                removeRecord(page_schema, page_schema.page_buffer + pos);
             std::copy(page_schema.page_buffer + pos + page_schema.value_size + page_schema.key_size, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + pos);
             --page_schema.size;
-            std::copy(reinterpret_cast<const char *>(&page_schema.size), reinterpret_cast<const char *>(&page_schema.size) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfSize);
+            writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
             file_system.write(page_schema.page_id, page_schema.page_ptr);
         }
     }
     else
     {
-        if (pos < page_schema.total_size && page_schema.compare(key, page_schema.page_buffer + pos, page_schema.key_size) == 0)
+        if (pos < page_schema.total_size && std::memcmp(key, page_schema.page_buffer + pos, page_schema.key_size) == 0)
             pos += page_schema.key_size + page_schema.value_size;
         if (pos == kOffsetOfPageHeader)
             return;
@@ -316,6 +944,11 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
         PageSchema child_page_schema = getPageSchema(child_page_id);
         if (!pageIsMinimum(child_page_schema))
             return BPlusTreeDelete(child_page_id, key, root_page_id_ptr);
+        if (child_page_schema.prefix_size)
+        {
+            setPagePrefix(child_page_schema, nullptr, 0);
+            file_system.write(child_page_schema.page_id, child_page_schema.page_ptr);
+        }
         if (left_child_page_pos != -1)
         {
             size_t left_child_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + left_child_page_pos);
@@ -324,12 +957,16 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
             {
                 size_t left_child_pos = left_child_page_schema.total_size - left_child_page_schema.key_size - left_child_page_schema.value_size;
                 std::copy_backward(child_page_schema.page_buffer + kOffsetOfPageHeader, child_page_schema.page_buffer + child_page_schema.total_size, child_page_schema.page_buffer + child_page_schema.total_size + child_page_schema.key_size + child_page_schema.value_size);
-                std::copy(left_child_page_schema.page_buffer + left_child_pos, left_child_page_schema.page_buffer + left_child_pos + left_child_page_schema.key_size + left_child_page_schema.value_size, child_page_schema.page_buffer + kOffsetOfPageHeader);
-                std::copy(left_child_page_schema.page_buffer + left_child_pos, left_child_page_schema.page_buffer + left_child_pos + left_child_page_schema.key_size, page_schema.page_buffer + child_page_pos - page_schema.key_size);
+                transferEntry(left_child_page_schema, left_child_page_schema.page_buffer + left_child_pos, child_page_schema, child_page_schema.page_buffer + kOffsetOfPageHeader);
+                copyKey(left_child_page_schema, left_child_page_schema.page_buffer + left_child_pos, page_schema.page_buffer + child_page_pos - page_schema.key_size);
+                if (pageIsSlotted(left_child_page_schema))
+                    removeRecord(left_child_page_schema, left_child_page_schema.page_buffer + left_child_pos);
                 --left_child_page_schema.size;
-                std::copy(reinterpret_cast<const char *>(&left_child_page_schema.size), reinterpret_cast<const char *>(&left_child_page_schema.size) + kSizeOfSizeT, left_child_page_schema.page_buffer + kOffsetOfSize);
+                writeHeaderField(left_child_page_schema.page_buffer, kOffsetOfSize, left_child_page_schema.size);
                 ++child_page_schema.size;
-                std::copy(reinterpret_cast<const char *>(&child_page_schema.size), reinterpret_cast<const char *>(&child_page_schema.size) + kSizeOfSizeT, child_page_schema.page_buffer + kOffsetOfSize);
+                writeHeaderField(child_page_schema.page_buffer, kOffsetOfSize, child_page_schema.size);
+                child_page_schema.total_size += child_page_schema.key_size + child_page_schema.value_size;
+                compactPrefix(child_page_schema);
                 file_system.write(page_schema.page_id, page_schema.page_ptr);
                 file_system.write(left_child_page_schema.page_id, left_child_page_schema.page_ptr);
                 file_system.write(child_page_schema.page_id, child_page_schema.page_ptr);
@@ -343,13 +980,17 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
             if (!pageIsMinimum(right_child_page_schema))
             {
                 size_t right_child_pos = kOffsetOfPageHeader;
-                std::copy(right_child_page_schema.page_buffer + right_child_pos, right_child_page_schema.page_buffer + right_child_pos + right_child_page_schema.key_size + right_child_page_schema.value_size, child_page_schema.page_buffer + child_page_schema.total_size);
+                transferEntry(right_child_page_schema, right_child_page_schema.page_buffer + right_child_pos, child_page_schema, child_page_schema.page_buffer + child_page_schema.total_size);
+                if (pageIsSlotted(right_child_page_schema))
+                    removeRecord(right_child_page_schema, right_child_page_schema.page_buffer + right_child_pos);
                 std::copy(right_child_page_schema.page_buffer + right_child_pos + right_child_page_schema.key_size + right_child_page_schema.value_size, right_child_page_schema.page_buffer + right_child_page_schema.total_size, right_child_page_schema.page_buffer + right_child_pos);
-                std::copy(right_child_page_schema.page_buffer + right_child_pos, right_child_page_schema.page_buffer + right_child_pos + right_child_page_schema.key_size, page_schema.page_buffer + child_page_pos + page_schema.value_size);
+                copyKey(right_child_page_schema, right_child_page_schema.page_buffer + right_child_pos, page_schema.page_buffer + child_page_pos + page_schema.value_size);
                 --right_child_page_schema.size;
-                std::copy(reinterpret_cast<const char *>(&right_child_page_schema.size), reinterpret_cast<const char *>(&right_child_page_schema.size) + kSizeOfSizeT, right_child_page_schema.page_buffer + kOffsetOfSize);
+                writeHeaderField(right_child_page_schema.page_buffer, kOffsetOfSize, right_child_page_schema.size);
                 ++child_page_schema.size;
-                std::copy(reinterpret_cast<const char *>(&child_page_schema.size), reinterpret_cast<const char *>(&child_page_schema.size) + kSizeOfSizeT, child_page_schema.page_buffer + kOffsetOfSize);
+                writeHeaderField(child_page_schema.page_buffer, kOffsetOfSize, child_page_schema.size);
+                child_page_schema.total_size += child_page_schema.key_size + child_page_schema.value_size;
+                compactPrefix(child_page_schema);
                 file_system.write(page_schema.page_id, page_schema.page_ptr);
                 file_system.write(right_child_page_schema.page_id, right_child_page_schema.page_ptr);
                 file_system.write(child_page_schema.page_id, child_page_schema.page_ptr);
@@ -360,16 +1001,26 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
         {
             size_t left_child_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + left_child_page_pos);
             PageSchema left_child_page_schema = getPageSchema(left_child_page_id);
-            std::copy(child_page_schema.page_buffer + kOffsetOfPageHeader, child_page_schema.page_buffer + child_page_schema.total_size, left_child_page_schema.page_buffer + left_child_page_schema.total_size);
-            std::copy(child_page_schema.page_buffer + kOffsetOfRightPageId, child_page_schema.page_buffer + kOffsetOfRightPageId + kSizeOfSizeT, left_child_page_schema.page_buffer + kOffsetOfRightPageId);
+            if (left_child_page_schema.prefix_size)
+                setPagePrefix(left_child_page_schema, nullptr, 0);
+            if (pageIsSlotted(child_page_schema))
+            {
+                for (size_t child_pos = kOffsetOfPageHeader; child_pos < child_page_schema.total_size; child_pos += child_page_schema.key_size + child_page_schema.value_size)
+                    transferEntry(child_page_schema, child_page_schema.page_buffer + child_pos, left_child_page_schema, left_child_page_schema.page_buffer + left_child_page_schema.total_size + child_pos - kOffsetOfPageHeader);
+            }
+            else
+                std::copy(child_page_schema.page_buffer + kOffsetOfPageHeader, child_page_schema.page_buffer + child_page_schema.total_size, left_child_page_schema.page_buffer + left_child_page_schema.total_size);
+            writeHeaderField(left_child_page_schema.page_buffer, kOffsetOfRightPageId, readHeaderField(child_page_schema.page_buffer, kOffsetOfRightPageId));
             left_child_page_schema.size += child_page_schema.size;
+            left_child_page_schema.total_size += child_page_schema.total_size - kOffsetOfPageHeader;
             std::copy(page_schema.page_buffer + child_page_pos + page_schema.value_size, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + child_page_pos - page_schema.key_size);
             --page_schema.size;
-            std::copy(reinterpret_cast<const char *>(&left_child_page_schema.size), reinterpret_cast<const char *>(&left_child_page_schema.size) + kSizeOfSizeT, left_child_page_schema.page_buffer + kOffsetOfSize);
-            std::copy(reinterpret_cast<const char *>(&page_schema.size), reinterpret_cast<const char *>(&page_schema.size) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfSize);
+            writeHeaderField(left_child_page_schema.page_buffer, kOffsetOfSize, left_child_page_schema.size);
+            writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
+            compactPrefix(left_child_page_schema);
             GDBE &gdbe = GDBE::getInstance();
             gdbe.addFreePage(child_page_schema.page_id);
-            if (page_schema.size == 1)
+            if (page_schema.size == 1 && page_schema.page_id == *root_page_id_ptr)
             {
                 gdbe.addFreePage(page_schema.page_id);
                 *root_page_id_ptr = left_child_page_schema.page_id;
@@ -382,16 +1033,26 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
         {
             size_t right_child_page_id = *reinterpret_cast<const size_t *>(page_schema.page_buffer + right_child_page_pos);
             PageSchema right_child_page_schema = getPageSchema(right_child_page_id);
-            std::copy(right_child_page_schema.page_buffer + kOffsetOfPageHeader, right_child_page_schema.page_buffer + right_child_page_schema.total_size, child_page_schema.page_buffer + child_page_schema.total_size);
-            std::copy(right_child_page_schema.page_buffer + kOffsetOfRightPageId, right_child_page_schema.page_buffer + kOffsetOfRightPageId + kSizeOfSizeT, child_page_schema.page_buffer + kOffsetOfRightPageId);
+            if (right_child_page_schema.prefix_size)
+                setPagePrefix(right_child_page_schema, nullptr, 0);
+            if (pageIsSlotted(right_child_page_schema))
+            {
+                for (size_t right_child_pos = kOffsetOfPageHeader; right_child_pos < right_child_page_schema.total_size; right_child_pos += right_child_page_schema.key_size + right_child_page_schema.value_size)
+                    transferEntry(right_child_page_schema, right_child_page_schema.page_buffer + right_child_pos, child_page_schema, child_page_schema.page_buffer + child_page_schema.total_size + right_child_pos - kOffsetOfPageHeader);
+            }
+            else
+                std::copy(right_child_page_schema.page_buffer + kOffsetOfPageHeader, right_child_page_schema.page_buffer + right_child_page_schema.total_size, child_page_schema.page_buffer + child_page_schema.total_size);
+            writeHeaderField(child_page_schema.page_buffer, kOffsetOfRightPageId, readHeaderField(right_child_page_schema.page_buffer, kOffsetOfRightPageId));
             child_page_schema.size += right_child_page_schema.size;
+            child_page_schema.total_size += right_child_page_schema.total_size - kOffsetOfPageHeader;
             std::copy(page_schema.page_buffer + child_page_pos + page_schema.value_size * 2 + page_schema.key_size, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + child_page_pos + page_schema.value_size);
             --page_schema.size;
-            std::copy(reinterpret_cast<const char *>(&child_page_schema.size), reinterpret_cast<const char *>(&child_page_schema.size) + kSizeOfSizeT, child_page_schema.page_buffer + kOffsetOfSize);
-            std::copy(reinterpret_cast<const char *>(&page_schema.size), reinterpret_cast<const char *>(&page_schema.size) + kSizeOfSizeT, page_schema.page_buffer + kOffsetOfSize);
+            writeHeaderField(child_page_schema.page_buffer, kOffsetOfSize, child_page_schema.size);
+            writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
+            compactPrefix(child_page_schema);
             GDBE &gdbe = GDBE::getInstance();
             gdbe.addFreePage(right_child_page_schema.page_id);
-            if (page_schema.size == 1)
+            if (page_schema.size == 1 && page_schema.page_id == *root_page_id_ptr)
             {
                 gdbe.addFreePage(page_schema.page_id);
                 *root_page_id_ptr = child_page_schema.page_id;
@@ -400,5 +1061,149 @@ void BPlusTreeDelete(size_t page_id, char *key, size_t *root_page_id_ptr)
             file_system.write(child_page_schema.page_id, child_page_schema.page_ptr);
             return BPlusTreeDelete(child_page_schema.page_id, key, root_page_id_ptr);
         }
+        return BPlusTreeDelete(child_page_id, key, root_page_id_ptr);
+    }
+}
+
+void BPlusTreeDeleteRange(size_t page_id, char *begin_key, char *end_key, bool is_index, size_t *root_page_id_ptr)
+{
+    FileSystem &file_system = FileSystem::getInstance();
+    GDBE &gdbe = GDBE::getInstance();
+    size_t level = getTreeLevel(page_id);
+    size_t first_leaf_page_id = -1, last_leaf_page_id = -1;
+    std::pair<size_t, size_t> left_pair = {-1, 0};
+    size_t size = deleteRangeFromPage(page_id, level, begin_key, end_key, is_index, &first_leaf_page_id, &last_leaf_page_id, &left_pair);
+    if (first_leaf_page_id != -1)
+    {
+        size_t left_page_id = left_pair.first;
+        for (size_t i = left_pair.second; i > 0 && left_page_id != -1; --i)
+        {
+            PageSchema left_page_schema = getPageSchema(left_page_id);
+            left_page_id = *reinterpret_cast<const size_t *>(left_page_schema.page_buffer + left_page_schema.total_size - left_page_schema.value_size);
+        }
+        size_t right_page_id = getPageSchema(last_leaf_page_id).right_page_id;
+        if (left_page_id != -1)
+        {
+            PageSchema left_page_schema = getPageSchema(left_page_id);
+            writeHeaderField(left_page_schema.page_buffer, kOffsetOfRightPageId, right_page_id);
+            file_system.write(left_page_id, left_page_schema.page_ptr);
+        }
+        if (right_page_id != -1)
+        {
+            PageSchema right_page_schema = getPageSchema(right_page_id);
+            writeHeaderField(right_page_schema.page_buffer, kOffsetOfLeftPageId, left_page_id);
+            file_system.write(right_page_id, right_page_schema.page_ptr);
+        }
+    }
+    if (level == 0)
+        return;
+    if (size == 0)
+    {
+        PageSchema leaf_page_schema = getPageSchema(first_leaf_page_id);
+        PageSchema new_page_schema(true, 0, -1, -1, leaf_page_schema.key_size + leaf_page_schema.prefix_size, leaf_page_schema.index_size + leaf_page_schema.prefix_size, leaf_page_schema.value_size, leaf_page_schema.tree_id);
+        new_page_schema.heap_size = pageIsSlotted(leaf_page_schema) ? 0 : -1;
+        gdbe.addFreePage(page_id);
+        *root_page_id_ptr = createNewPage(new_page_schema);
+        return;
+    }
+    PageSchema page_schema = getPageSchema(page_id);
+    while (!page_schema.leaf && page_schema.size == 1)
+    {
+        gdbe.addFreePage(page_schema.page_id);
+        *root_page_id_ptr = *reinterpret_cast<const size_t *>(page_schema.page_buffer + kOffsetOfPageHeader + page_schema.key_size);
+        page_schema = getPageSchema(*root_page_id_ptr);
+    }
+}
+
+size_t deleteRangeFromPage(size_t page_id, size_t level, char *begin_key, char *end_key, bool is_index, size_t *first_leaf_page_id_ptr, size_t *last_leaf_page_id_ptr, std::pair<size_t, size_t> *left_pair_ptr)
+{
+    FileSystem &file_system = FileSystem::getInstance();
+    GDBE &gdbe = GDBE::getInstance();
+    PageSchema page_schema = getPageSchema(page_id);
+    size_t compare_size = is_index ? page_schema.index_size : page_schema.key_size;
+    size_t entry_size = page_schema.key_size + page_schema.value_size;
+    if (page_schema.leaf)
+    {
+        size_t begin_pos = begin_key ? lowerBoundInPage(page_schema, kOffsetOfPageHeader, begin_key, compare_size) : kOffsetOfPageHeader;
+        size_t end_pos = end_key ? upperBoundInPage(page_schema, begin_pos, end_key, compare_size) : page_schema.total_size;
+        if (begin_pos != end_pos)
+        {
+            std::copy(page_schema.page_buffer + end_pos, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + begin_pos);
+            page_schema.size -= (end_pos - begin_pos) / entry_size;
+            page_schema.total_size -= end_pos - begin_pos;
+            writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
+            if (pageIsSlotted(page_schema))
+                compactHeap(page_schema);
+            file_system.write(page_id, page_schema.page_ptr);
+        }
+        if (page_schema.size != 0 && begin_pos != kOffsetOfPageHeader)
+            *left_pair_ptr = {page_id, 0};
+        return page_schema.size;
+    }
+    size_t new_total_size = kOffsetOfPageHeader;
+    for (size_t pos = kOffsetOfPageHeader; pos < page_schema.total_size; pos += entry_size)
+    {
+        char *key = page_schema.page_buffer + pos;
+        char *next_key = pos + entry_size < page_schema.total_size ? key + entry_size : nullptr;
+        size_t child_page_id = *reinterpret_cast<const size_t *>(key + page_schema.key_size);
+        bool keep = true;
+        if (end_key && std::memcmp(end_key, key, compare_size) < 0)
+        {
+            std::copy(key, page_schema.page_buffer + page_schema.total_size, page_schema.page_buffer + new_total_size);
+            new_total_size += page_schema.total_size - pos;
+            break;
+        }
+        else if (begin_key && next_key && std::memcmp(begin_key, next_key, compare_size) > 0)
+            *left_pair_ptr = {child_page_id, level - 1};
+        else if ((!begin_key || std::memcmp(begin_key, key, compare_size) <= 0) && (!end_key || (next_key && std::memcmp(next_key, end_key, compare_size) <= 0)))
+        {
+            removeSubTree(child_page_id, level - 1, first_leaf_page_id_ptr, last_leaf_page_id_ptr);
+            keep = false;
+        }
+        else if (deleteRangeFromPage(child_page_id, level - 1, begin_key, end_key, is_index, first_leaf_page_id_ptr, last_leaf_page_id_ptr, left_pair_ptr) == 0)
+        {
+            if (level == 1)
+            {
+                if (*first_leaf_page_id_ptr == -1)
+                    *first_leaf_page_id_ptr = child_page_id;
+                *last_leaf_page_id_ptr = child_page_id;
+            }
+            gdbe.addFreePage(child_page_id);
+            keep = false;
+        }
+        if (keep)
+        {
+            if (new_total_size != pos)
+                std::copy(key, key + entry_size, page_schema.page_buffer + new_total_size);
+            new_total_size += entry_size;
+        }
+    }
+    if (new_total_size != page_schema.total_size)
+    {
+        page_schema.size = (new_total_size - kOffsetOfPageHeader) / entry_size;
+        writeHeaderField(page_schema.page_buffer, kOffsetOfSize, page_schema.size);
+        file_system.write(page_id, page_schema.page_ptr);
+    }
+    return page_schema.size;
+}
+
+// Counts the pages of a tree held in the buffer pool. A page still being
+// read ahead is skipped, as its bytes are not there to decode yet.
+size_t BPlusTreeResidentCount(size_t page_id)
+{
+    if (page_id == -1)
+        return 0;
+    Page *page = BufferPool::getInstance().peekPage(page_id);
+    if (!page || page->io_pending)
+        return 0;
+    if (!page->header_valid)
+        decodePageHeader(page);
+    const PageHeader &page_schema = page->header;
+    size_t count = 1;
+    if (!page_schema.leaf)
+    {
+        for (size_t pos = kOffsetOfPageHeader; pos < page_schema.total_size; pos += page_schema.key_size + page_schema.value_size)
+            count += BPlusTreeResidentCount(*reinterpret_cast<const size_t *>(page_schema.page_buffer + pos + page_schema.key_size));
     }
+    return count;
 }
\ No newline at end of file
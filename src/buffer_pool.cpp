@@ -1,4 +1,7 @@
+#include <algorithm>
+#include <cstdlib>
 #include "buffer_pool.h"
+#include "error.h"
 
 BufferPool &BufferPool::getInstance()
 {
@@ -6,27 +9,388 @@ BufferPool &BufferPool::getInstance()
     return buffer_pool;
 }
 
-PagePtr BufferPool::getPage(size_t page_id)
+BufferPool::BufferPool() : file_system_(FileSystem::getInstance())
 {
-    if (id_page_map_.find(page_id) != id_page_map_.end())
+    resize(kDefaultSize);
+}
+
+BufferPool::~BufferPool()
+{
+    file_system_.drainReads();
+    for (auto &&extent : extent_vector_)
+        free(extent.arena);
+}
+
+Page *BufferPool::fetchPage(size_t page_id, bool scan)
+{
+    PageKey page_key{file_system_.getFileId(), page_id};
+    auto iter = id_page_map_.find(page_key);
+    if (iter != id_page_map_.end())
+    {
+        ++hit_count_;
+        Page *page = iter->second;
+        file_system_.waitRead(page);
+        if (scan)
+            return page;
+        if (page->queue == kAmQueue)
+        {
+            am_list_.remove(page);
+            am_list_.pushFront(page);
+        }
+        else if (page->queue == kScanQueue)
+        {
+            scan_list_.remove(page);
+            a1in_list_.pushFront(page);
+            page->queue = kA1inQueue;
+        }
+        return page;
+    }
+    ++miss_count_;
+    Page *page = getFreeFrame(scan);
+    page->file_id = page_key.first;
+    page->page_id = page_id;
+    page->buffer = page->frame_buffer;
+    try
+    {
+        file_system_.read(page_id, PagePtr(page));
+    }
+    catch (const Error &error)
     {
-        page_ptr_list_.push_front(*id_page_map_[page_id]);
-        page_ptr_list_.erase(id_page_map_[page_id]);
-        id_page_map_[page_id] = page_ptr_list_.begin();
+        releaseFrame(page);
+        throw;
     }
+    if (scan)
+        page->queue = kScanQueue;
     else
     {
-        if (page_ptr_list_.size() == kMaxSize)
+        auto a1out_iter = a1out_map_.find(page_key);
+        if (a1out_iter != a1out_map_.end())
+        {
+            a1out_list_.erase(a1out_iter->second);
+            a1out_map_.erase(a1out_iter);
+            page->queue = kAmQueue;
+        }
+        else
+            page->queue = kA1inQueue;
+    }
+    getList(page->queue).pushFront(page);
+    id_page_map_[page_key] = page;
+    return page;
+}
+
+void BufferPool::clear(size_t file_id)
+{
+    for (auto &&extent : extent_vector_)
+    {
+        for (auto &&page : extent.frame_vector)
+        {
+            if (page.queue == kFreeQueue || page.file_id != file_id)
+                continue;
+            id_page_map_.erase({page.file_id, page.page_id});
+            page.page_id = -1;
+            if (page.pin_count == 0)
+            {
+                getList(page.queue).remove(&page);
+                page.queue = kFreeQueue;
+                free_list_.pushFront(&page);
+            }
+        }
+    }
+    for (auto iter = a1out_list_.begin(); iter != a1out_list_.end();)
+    {
+        if (iter->first == file_id)
+        {
+            a1out_map_.erase(*iter);
+            iter = a1out_list_.erase(iter);
+        }
+        else
+            ++iter;
+    }
+}
+
+std::vector<size_t> BufferPool::getResidentPages(size_t file_id)
+{
+    std::vector<size_t> internal_vector, leaf_vector;
+    for (PageList *page_list : {&am_list_, &a1in_list_})
+    {
+        for (Page *page = page_list->back(); page; page = page->prev)
+        {
+            if (page->file_id != file_id || page->page_id == -1 || page->io_pending)
+                continue;
+            if (*reinterpret_cast<const bool *>(page->buffer + kOffsetOfLeaf))
+                leaf_vector.push_back(page->page_id);
+            else
+                internal_vector.push_back(page->page_id);
+        }
+    }
+    std::reverse(internal_vector.begin(), internal_vector.end());
+    std::reverse(leaf_vector.begin(), leaf_vector.end());
+    internal_vector.insert(internal_vector.end(), leaf_vector.begin(), leaf_vector.end());
+    return internal_vector;
+}
+
+size_t BufferPool::prefetch(std::vector<size_t> page_id_vector)
+{
+    size_t file_id = file_system_.getFileId();
+    std::vector<size_t> load_vector;
+    for (auto &&page_id : page_id_vector)
+    {
+        if (load_vector.size() == free_list_.size())
+            break;
+        if (id_page_map_.find({file_id, page_id}) == id_page_map_.end())
+            load_vector.push_back(page_id);
+    }
+    std::sort(load_vector.begin(), load_vector.end());
+    load_vector.erase(std::unique(load_vector.begin(), load_vector.end()), load_vector.end());
+    size_t count = 0;
+    for (size_t i = 0, j = 0; i < load_vector.size(); i = j)
+    {
+        std::vector<PagePtr> page_ptr_vector;
+        for (j = i; j < load_vector.size() && load_vector[j] == load_vector[i] + (j - i); ++j)
+        {
+            Page *page = free_list_.back();
+            free_list_.remove(page);
+            page->file_id = file_id;
+            page->page_id = load_vector[j];
+            page->buffer = page->frame_buffer;
+            page_ptr_vector.push_back(PagePtr(page));
+        }
+        try
+        {
+            count += file_system_.readPages(load_vector[i], page_ptr_vector);
+        }
+        catch (const Error &error)
+        {
+            for (auto &&page_ptr : page_ptr_vector)
+                releaseFrame(page_ptr.get());
+            throw;
+        }
+        for (auto &&page_ptr : page_ptr_vector)
+        {
+            page_ptr->queue = kAmQueue;
+            am_list_.pushFront(page_ptr.get());
+            id_page_map_[{file_id, page_ptr->page_id}] = page_ptr.get();
+        }
+    }
+    return count;
+}
+
+size_t BufferPool::readAhead(const std::vector<size_t> &page_id_vector)
+{
+    if (file_system_.isMmap())
+    {
+        for (auto &&page_id : page_id_vector)
+            adviseWillNeed(page_id);
+        return 0;
+    }
+    file_system_.reapReads();
+    size_t file_id = file_system_.getFileId();
+    size_t count = 0;
+    for (auto &&page_id : page_id_vector)
+    {
+        if (file_system_.readsInFlight() >= kReadAheadSize)
+            break;
+        PageKey page_key{file_id, page_id};
+        if (page_id == -1 || id_page_map_.find(page_key) != id_page_map_.end())
+            continue;
+        Page *page = nullptr;
+        try
         {
-            auto last_page_ptr = page_ptr_list_.back();
-            page_ptr_list_.pop_back();
-            id_page_map_.erase(last_page_ptr->page_id);
+            page = getFreeFrame(true);
         }
-        PagePtr page_ptr(new Page);
-        page_ptr->page_id = page_id;
-        file_system_.read(page_id, page_ptr);
-        page_ptr_list_.push_front(page_ptr);
-        id_page_map_[page_id] = page_ptr_list_.begin();
+        catch (const Error &error)
+        {
+            break;
+        }
+        page->file_id = file_id;
+        page->page_id = page_id;
+        page->buffer = page->frame_buffer;
+        if (!file_system_.readAsync(page_id, page))
+        {
+            free_list_.pushFront(page);
+            continue;
+        }
+        page->queue = kScanQueue;
+        scan_list_.pushFront(page);
+        id_page_map_[page_key] = page;
+        ++count;
+    }
+    read_ahead_count_ += count;
+    return count;
+}
+
+size_t BufferPool::resize(size_t size)
+{
+    if (size < kMinSize)
+        size = kMinSize;
+    while (capacity_ < size)
+        addExtent();
+    while (capacity_ >= size + kExtentSize && removeExtent())
+        ;
+    a1in_size_ = capacity_ / 4;
+    a1out_size_ = capacity_ / 2;
+    while (a1out_list_.size() > a1out_size_)
+    {
+        a1out_map_.erase(a1out_list_.back());
+        a1out_list_.pop_back();
+    }
+    id_page_map_.reserve(capacity_);
+    return capacity_;
+}
+
+// Pages are written through as they change, so the cached ones can simply
+// be dropped before the frames grow.
+void BufferPool::reserveFrameSize(size_t page_size)
+{
+    if (page_size <= frame_size_)
+        return;
+    file_system_.drainReads();
+    if (pinnedCount())
+        throw Error(kMemoryError, "buffer pool");
+    size_t capacity = capacity_;
+    while (!extent_vector_.empty() && removeExtent())
+        ;
+    frame_size_ = page_size;
+    resize(capacity);
+}
+
+size_t BufferPool::pinnedCount() const
+{
+    size_t count = 0;
+    for (auto &&extent : extent_vector_)
+    {
+        for (auto &&page : extent.frame_vector)
+            count += page.pin_count != 0;
+    }
+    return count;
+}
+
+void BufferPool::addExtent()
+{
+    void *arena = nullptr;
+    if (posix_memalign(&arena, kFrameAlignment, kExtentSize * frame_size_))
+        throw Error(kMemoryError, "buffer pool");
+    extent_vector_.push_back(Extent());
+    Extent &extent = extent_vector_.back();
+    extent.arena = static_cast<char *>(arena);
+    extent.frame_vector.reserve(kExtentSize);
+    for (size_t i = 0; i < kExtentSize; ++i)
+    {
+        extent.frame_vector.emplace_back(-1, extent.arena + i * frame_size_);
+        free_list_.pushFront(&extent.frame_vector.back());
+    }
+    capacity_ += kExtentSize;
+}
+
+bool BufferPool::removeExtent()
+{
+    Extent &extent = extent_vector_.back();
+    for (auto &&page : extent.frame_vector)
+    {
+        if (page.pin_count)
+            return false;
+    }
+    for (auto &&page : extent.frame_vector)
+    {
+        if (page.queue != kFreeQueue)
+        {
+            auto iter = id_page_map_.find({page.file_id, page.page_id});
+            if (iter != id_page_map_.end() && iter->second == &page)
+                id_page_map_.erase(iter);
+            ++eviction_count_;
+        }
+        getList(page.queue).remove(&page);
+    }
+    free(extent.arena);
+    extent_vector_.pop_back();
+    capacity_ -= kExtentSize;
+    return true;
+}
+
+// A scan miss recycles the tail of a full scan ring even while free frames
+// remain, and any other miss takes an unpinned scan page before it touches
+// A1in or Am, so a scan never holds more than kScanRingSize frames for long.
+Page *BufferPool::getFreeFrame(bool scan)
+{
+    Page *page = nullptr;
+    if (scan && scan_list_.size() >= kScanRingSize)
+        page = evict(scan_list_);
+    if (page)
+        return page;
+    page = free_list_.back();
+    if (page)
+    {
+        free_list_.remove(page);
+        return page;
+    }
+    page = evict(scan_list_);
+    if (!page && (a1in_list_.size() > a1in_size_ || am_list_.size() == 0))
+    {
+        page = evict(a1in_list_);
+        if (page)
+            pushA1out({page->file_id, page->page_id});
+    }
+    if (!page)
+        page = evict(am_list_);
+    if (!page)
+    {
+        page = evict(a1in_list_);
+        if (page)
+            pushA1out({page->file_id, page->page_id});
+    }
+    if (!page)
+        throw Error(kMemoryError, "buffer pool");
+    return page;
+}
+
+Page *BufferPool::evict(PageList &page_list)
+{
+    Page *page = page_list.back();
+    while (page && page->pin_count)
+        page = page->prev;
+    if (!page)
+        return nullptr;
+    page_list.remove(page);
+    auto iter = id_page_map_.find({page->file_id, page->page_id});
+    if (iter != id_page_map_.end() && iter->second == page)
+        id_page_map_.erase(iter);
+    page->queue = kFreeQueue;
+    ++eviction_count_;
+    return page;
+}
+
+// Hands back a frame taken by getFreeFrame() whose page could not be read.
+void BufferPool::releaseFrame(Page *page)
+{
+    page->page_id = -1;
+    page->queue = kFreeQueue;
+    free_list_.pushFront(page);
+}
+
+void BufferPool::pushA1out(const PageKey &page_key)
+{
+    if (page_key.second == -1)
+        return;
+    a1out_list_.push_front(page_key);
+    a1out_map_[page_key] = a1out_list_.begin();
+    if (a1out_list_.size() > a1out_size_)
+    {
+        a1out_map_.erase(a1out_list_.back());
+        a1out_list_.pop_back();
+    }
+}
+
+PageList &BufferPool::getList(PageQueue queue)
+{
+    switch (queue)
+    {
+    case kA1inQueue:
+        return a1in_list_;
+    case kAmQueue:
+        return am_list_;
+    case kScanQueue:
+        return scan_list_;
+    default:
+        return free_list_;
     }
-    return page_ptr_list_.front();
 }
\ No newline at end of file
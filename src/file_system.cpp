@@ -1,7 +1,309 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "file_system.h"
+#include "error.h"
+#include "page_codec.h"
 
 FileSystem &FileSystem::getInstance()
 {
     static FileSystem file_system;
     return file_system;
+}
+
+void FileSystem::read(size_t page_id, const PagePtr &page_ptr)
+{
+    DatabaseFile &database_file = file_map_[page_ptr->file_id];
+    size_t page_size = database_file.page_size;
+    page_ptr->page_size = page_size;
+    page_ptr->header_valid = false;
+    ++read_count_;
+    if (mmap_)
+    {
+        page_ptr->buffer = mapPage(database_file, page_id);
+        decompressPage(page_ptr.get());
+        return;
+    }
+    if ((page_id + 1) * page_size > database_file.file_size)
+    {
+        std::fill(page_ptr->buffer, page_ptr->buffer + page_size, 0);
+        write(page_id, page_ptr);
+        return;
+    }
+    if (pread(database_file.fd, page_ptr->buffer, page_size, page_id * page_size) != static_cast<ssize_t>(page_size))
+        throw Error(kMemoryError, database_file.filename);
+    decompressPage(page_ptr.get());
+}
+
+void FileSystem::write(size_t page_id, const PagePtr &page_ptr)
+{
+    DatabaseFile &database_file = file_map_[page_ptr->file_id];
+    size_t page_size = database_file.page_size;
+    page_ptr->header_valid = false;
+    ++write_count_;
+    if (mmap_)
+        return;
+    const char *buffer = page_ptr->buffer;
+    size_t write_size = compressPage(database_file, buffer);
+    if (write_size)
+    {
+        buffer = codec_buffer_;
+        ++compressed_write_count_;
+        if ((page_id + 1) * page_size > database_file.file_size && ftruncate(database_file.fd, (page_id + 1) * page_size))
+            throw Error(kMemoryError, database_file.filename);
+    }
+    else
+        write_size = page_size;
+    if (pwrite(database_file.fd, buffer, write_size, page_id * page_size) != static_cast<ssize_t>(write_size))
+        throw Error(kMemoryError, database_file.filename);
+    if (write_size < page_size && database_file.punch_hole && fallocate(database_file.fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, page_id * page_size + write_size, page_size - write_size))
+    {
+        if (errno != EOPNOTSUPP)
+            throw Error(kMemoryError, database_file.filename);
+        database_file.punch_hole = false;
+    }
+    if ((page_id + 1) * page_size > database_file.file_size)
+        database_file.file_size = (page_id + 1) * page_size;
+}
+
+// Leaves the compressed copy of a page of a COMPRESSED table in
+// codec_buffer_, and returns its size rounded up to kMapAlignment so that
+// direct I/O can write it, or 0 when the page is written as it is.
+size_t FileSystem::compressPage(const DatabaseFile &database_file, const char *buffer)
+{
+    if (database_file.compressed_tree_set.find(readHeaderField(buffer, kOffsetOfTreeId)) == database_file.compressed_tree_set.end())
+        return 0;
+    size_t page_size = database_file.page_size;
+    allocateCodecBuffer();
+    uint32_t size = compressBlock(buffer + kOffsetOfPageCodec, page_size - kOffsetOfPageCodec, codec_buffer_ + kOffsetOfCodecBody, page_size - kOffsetOfCodecBody);
+    size_t write_size = (kOffsetOfCodecBody + size + kMapAlignment - 1) / kMapAlignment * kMapAlignment;
+    if (size == 0 || write_size >= page_size)
+        return 0;
+    uint32_t checksum = blockChecksum(codec_buffer_ + kOffsetOfCodecBody, size);
+    std::copy(buffer, buffer + kOffsetOfPageCodec, codec_buffer_);
+    std::fill(codec_buffer_ + kOffsetOfPageCodec, codec_buffer_ + kOffsetOfCodecSize, 0);
+    codec_buffer_[kOffsetOfPageCodec] = kPageCodecLz;
+    std::memcpy(codec_buffer_ + kOffsetOfCodecSize, &size, sizeof(size));
+    std::memcpy(codec_buffer_ + kOffsetOfCodecChecksum, &checksum, sizeof(checksum));
+    std::fill(codec_buffer_ + kOffsetOfCodecBody + size, codec_buffer_ + write_size, 0);
+    return write_size;
+}
+
+// Schema pages are not tree pages, so the codec byte alone does not mark a
+// page compressed; its codec output must also check out and decode to the
+// whole page.
+void FileSystem::decompressPage(Page *page)
+{
+    char *buffer = page->buffer;
+    if (buffer[kOffsetOfPageCodec] != kPageCodecLz)
+        return;
+    size_t page_size = page->page_size;
+    uint32_t size, checksum;
+    std::memcpy(&size, buffer + kOffsetOfCodecSize, sizeof(size));
+    std::memcpy(&checksum, buffer + kOffsetOfCodecChecksum, sizeof(checksum));
+    if (size > page_size - kOffsetOfCodecBody || blockChecksum(buffer + kOffsetOfCodecBody, size) != checksum)
+        return;
+    allocateCodecBuffer();
+    if (decompressBlock(buffer + kOffsetOfCodecBody, size, codec_buffer_, page_size - kOffsetOfPageCodec))
+        std::copy(codec_buffer_, codec_buffer_ + page_size - kOffsetOfPageCodec, buffer + kOffsetOfPageCodec);
+}
+
+void FileSystem::allocateCodecBuffer()
+{
+    if (!codec_buffer_ && posix_memalign(reinterpret_cast<void **>(&codec_buffer_), kMapAlignment, kMaxPageSize))
+        throw Error(kMemoryError, "");
+}
+
+size_t FileSystem::readPages(size_t first_page_id, const std::vector<PagePtr> &page_ptr_vector)
+{
+    DatabaseFile &database_file = file_map_[file_id_];
+    size_t page_size = database_file.page_size;
+    size_t count = 0;
+    for (auto &&page_ptr : page_ptr_vector)
+    {
+        size_t page_id = first_page_id + count;
+        page_ptr->page_size = page_size;
+        page_ptr->header_valid = false;
+        if (mmap_)
+        {
+            page_ptr->buffer = mapPage(database_file, page_id);
+            decompressPage(page_ptr.get());
+        }
+        else if ((page_id + 1) * page_size > database_file.file_size)
+            std::fill(page_ptr->buffer, page_ptr->buffer + page_size, 0);
+        else if (pread(database_file.fd, page_ptr->buffer, page_size, page_id * page_size) != static_cast<ssize_t>(page_size))
+            throw Error(kMemoryError, database_file.filename);
+        else
+            decompressPage(page_ptr.get());
+        ++count;
+    }
+    if (mmap_)
+        adviseWillNeed(first_page_id, count);
+    read_count_ += count;
+    return count;
+}
+
+bool FileSystem::readAsync(size_t page_id, Page *page)
+{
+    DatabaseFile &database_file = file_map_[page->file_id];
+    size_t page_size = database_file.page_size;
+    if (mmap_ || (page_id + 1) * page_size > database_file.file_size)
+        return false;
+    page->page_size = page_size;
+    page->header_valid = false;
+    page->io_pending = true;
+    ++page->pin_count;
+    ++read_count_;
+    async_io_.submit(page, database_file.fd, page_id * page_size, page_size);
+    return true;
+}
+
+void FileSystem::waitRead(Page *page)
+{
+    if (page->io_pending)
+        completeRead(page, async_io_.wait(page));
+}
+
+void FileSystem::reapReads()
+{
+    for (auto &&i : async_io_.reap())
+        completeRead(i.first, i.second);
+}
+
+void FileSystem::drainReads()
+{
+    for (auto &&i : async_io_.drain())
+        completeRead(i.first, i.second);
+}
+
+void FileSystem::completeRead(Page *page, bool success)
+{
+    page->io_pending = false;
+    page->header_valid = false;
+    --page->pin_count;
+    if (!success && page->page_id != -1)
+        read(page->page_id, PagePtr(page));
+    else if (success)
+        decompressPage(page);
+}
+
+void FileSystem::setFile(std::string filename)
+{
+    file_id_ = -1;
+    if (filename.empty())
+        return;
+    auto iter = file_id_map_.find(filename);
+    if (iter != file_id_map_.end())
+    {
+        file_id_ = iter->second;
+        return;
+    }
+    DatabaseFile database_file;
+    database_file.filename = filename;
+    openDatabaseFile(database_file);
+    file_id_ = next_file_id_++;
+    file_id_map_[filename] = file_id_;
+    file_map_[file_id_] = database_file;
+}
+
+size_t FileSystem::closeFile(const std::string &filename)
+{
+    auto iter = file_id_map_.find(filename);
+    if (iter == file_id_map_.end())
+        return -1;
+    size_t file_id = iter->second;
+    drainReads();
+    closeDatabaseFile(file_map_[file_id]);
+    file_map_.erase(file_id);
+    file_id_map_.erase(iter);
+    if (file_id_ == file_id)
+        file_id_ = -1;
+    return file_id;
+}
+
+bool isValidPageSize(size_t page_size)
+{
+    return page_size >= kMinPageSize && page_size <= kMaxPageSize && (page_size & (page_size - 1)) == 0;
+}
+
+void FileSystem::openDatabaseFile(DatabaseFile &database_file)
+{
+    database_file.fd = open(database_file.filename.c_str(), O_RDWR);
+    if (database_file.fd == -1)
+        throw Error(kMemoryError, database_file.filename);
+    struct stat file_stat;
+    fstat(database_file.fd, &file_stat);
+    database_file.file_size = file_stat.st_size;
+    if (pread(database_file.fd, &database_file.page_size, kSizeOfSizeT, 0) != static_cast<ssize_t>(kSizeOfSizeT) || !isValidPageSize(database_file.page_size))
+    {
+        close(database_file.fd);
+        throw Error(kMemoryError, database_file.filename);
+    }
+    if (mmap_)
+        openMapping(database_file);
+    else if (direct_io_ && fcntl(database_file.fd, F_SETFL, fcntl(database_file.fd, F_GETFL) | O_DIRECT) == -1)
+    {
+        close(database_file.fd);
+        throw Error(kMemoryError, database_file.filename);
+    }
+}
+
+void FileSystem::closeDatabaseFile(DatabaseFile &database_file)
+{
+    if (database_file.map)
+        munmap(database_file.map, kMapReserveSize);
+    if (database_file.fd != -1)
+        close(database_file.fd);
+    database_file.map = nullptr;
+    database_file.fd = -1;
+}
+
+void FileSystem::openMapping(DatabaseFile &database_file)
+{
+    void *map = mmap(nullptr, kMapReserveSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        close(database_file.fd);
+        throw Error(kMemoryError, database_file.filename);
+    }
+    database_file.map = static_cast<char *>(map);
+    database_file.map_size = 0;
+    if (database_file.file_size)
+        mapPage(database_file, (database_file.file_size - 1) / database_file.page_size);
+}
+
+char *FileSystem::mapPage(DatabaseFile &database_file, size_t page_id)
+{
+    size_t end = (page_id + 1) * database_file.page_size;
+    if (end > database_file.map_size)
+    {
+        size_t map_size = (end + kMapChunkSize - 1) / kMapChunkSize * kMapChunkSize;
+        if (map_size > kMapReserveSize)
+            throw Error(kMemoryError, database_file.filename);
+        if (map_size > database_file.file_size && ftruncate(database_file.fd, map_size))
+            throw Error(kMemoryError, database_file.filename);
+        void *map = mmap(database_file.map + database_file.map_size, map_size - database_file.map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, database_file.fd, database_file.map_size);
+        if (map == MAP_FAILED)
+            throw Error(kMemoryError, database_file.filename);
+        madvise(map, map_size - database_file.map_size, MADV_RANDOM);
+        database_file.map_size = map_size;
+        if (map_size > database_file.file_size)
+            database_file.file_size = map_size;
+    }
+    return database_file.map + page_id * database_file.page_size;
+}
+
+void FileSystem::adviseWillNeed(size_t first_page_id, size_t count)
+{
+    if (!mmap_ || file_id_ == -1)
+        return;
+    DatabaseFile &database_file = file_map_[file_id_];
+    size_t begin = first_page_id * database_file.page_size;
+    size_t end = (first_page_id + count) * database_file.page_size;
+    if (end > database_file.map_size)
+        end = database_file.map_size;
+    if (begin < end)
+        madvise(database_file.map + begin, end - begin, MADV_WILLNEED);
 }
\ No newline at end of file
@@ -15,6 +15,8 @@ void GDBE::exec(SyntaxTree syntax_tree)
     query_optimizer_.optimizer(&syntax_tree);
     result_.clear();
     execRoot(syntax_tree_.root_);
+    if (++statement_count_ % kWarmupInterval == 0)
+        dumpWarmup();
 }
 
 Result GDBE::getResult()
@@ -49,7 +51,7 @@ Result GDBE::getResult()
         size_t count = 0;
         while (result_.iter != result_.end_iter && count < 200)
         {
-            auto value_vector = toTokenResultVector(*result_.iter, result_.data_type_vector, kSizeOfSizeT);
+            auto value_vector = toTokenResultVector(*result_.iter, result_.data_type_vector, result_.value_size_vector, kSizeOfSizeT);
             std::vector<std::string> temp_vector;
             for (auto &&i : value_vector)
             {
@@ -109,7 +111,14 @@ void GDBE::execRoot(Node &node)
     case kExplain:
         execExplain(node);
         break;
+    case kTruncate:
+        execTruncate(node);
+        break;
+    case kSet:
+        execSet(node);
+        break;
     case kExit:
+        dumpWarmup();
         result_.type = kExitResult;
         break;
     default:
@@ -144,16 +153,22 @@ void GDBE::execCreateDatabase(const Node &database_node)
     if (file_system_.exists(kDatabaseDir + string_node.token.str))
         throw Error(kDatabaseExistError, string_node.token.str);
     DatabaseSchema new_database_schema;
+    if (database_node.children.size() > 1)
+    {
+        const Node &value_node = database_node.children.back().children.front();
+        if (value_node.token.num <= 0 || !isValidPageSize(value_node.token.num))
+            throw Error(kIncorrectValueError, value_node.token.str);
+        new_database_schema.page_size = value_node.token.num;
+    }
     new_database_schema.page_vector.push_back(0);
-    std::vector<PagePtr> page_ptr_vector;
-    PagePtr page_ptr(new Page);
-    page_ptr_vector.push_back(page_ptr);
+    std::unique_ptr<char[]> buffer(new char[new_database_schema.page_size]());
+    Page page(0, buffer.get());
+    page.page_size = new_database_schema.page_size;
+    std::vector<PagePtr> page_ptr_vector{PagePtr(&page)};
     Stream stream(page_ptr_vector);
     stream << new_database_schema;
-    std::fstream file(string_node.token.str, std::fstream::out);
-    file_system_.swap(file);
-    file_system_.write(0, page_ptr_vector[0]);
-    file_system_.swap(file);
+    std::fstream file(string_node.token.str, std::fstream::out | std::fstream::binary);
+    file.write(page.buffer, new_database_schema.page_size);
     file.close();
     file_system_.rename(string_node.token.str, kDatabaseDir + string_node.token.str);
     result_.type = kCreateDatabaseResult;
@@ -173,6 +188,9 @@ void GDBE::execShow(const Node &show_node)
     case kIndex:
         execShowIndex(next_node);
         break;
+    case kBuffer:
+        execShowBufferPool(next_node);
+        break;
     default:
         throw Error(kSyntaxTreeError, next_node.token.str);
     }
@@ -201,21 +219,37 @@ void GDBE::execUse(const Node &use_node)
     {
         if (!file_system_.exists(kDatabaseDir + string_node.token.str))
             throw Error(kDatabaseNotExistError, string_node.token.str);
+        dumpWarmup();
         file_system_.setFile(kDatabaseDir + string_node.token.str);
-        buffer_pool_.clear();
-        std::vector<PagePtr> page_ptr_vector{buffer_pool_.getPage(0)};
-        Stream stream(page_ptr_vector);
+        buffer_pool_.reserveFrameSize(file_system_.pageSize());
         DatabaseSchema new_database_schema;
-        stream >> new_database_schema.page_vector;
-        page_ptr_vector.clear();
-        for (auto &&i : new_database_schema.page_vector)
+        auto database_schema_iter = database_schema_map_.find(string_node.token.str);
+        bool first_use = database_schema_iter == database_schema_map_.end();
+        if (!first_use)
         {
-            page_ptr_vector.push_back(buffer_pool_.getPage(i));
+            new_database_schema.swap(database_schema_iter->second);
+            database_schema_map_.erase(database_schema_iter);
+        }
+        else
+        {
+            std::vector<PagePtr> page_ptr_vector{buffer_pool_.getPage(0)};
+            Stream stream(page_ptr_vector);
+            stream >> new_database_schema.page_size >> new_database_schema.page_vector;
+            page_ptr_vector.clear();
+            for (auto &&i : new_database_schema.page_vector)
+            {
+                page_ptr_vector.push_back(buffer_pool_.getPage(i));
+            }
+            stream.setBuffer(page_ptr_vector);
+            stream >> new_database_schema;
         }
-        stream.setBuffer(page_ptr_vector);
-        stream >> new_database_schema;
+        if (!database_name_.empty())
+            database_schema_map_[database_name_].swap(database_schema_);
         database_schema_.swap(new_database_schema);
         database_name_ = string_node.token.str;
+        setCompressedTrees();
+        if (first_use)
+            loadWarmup();
     }
     result_.type = kUseResult;
 }
@@ -244,8 +278,10 @@ void GDBE::execDropDatabase(const Node &database_node)
     const Node &string_node = database_node.children.front().children.front();
     if (!file_system_.exists(kDatabaseDir + string_node.token.str))
         throw Error(kDatabaseNotExistError, string_node.token.str);
-    if (file_system_.getFilename() == kDatabaseDir + string_node.token.str)
-        file_system_.setFile("");
+    buffer_pool_.clear(file_system_.closeFile(kDatabaseDir + string_node.token.str));
+    database_schema_map_.erase(string_node.token.str);
+    if (file_system_.exists(kWarmupDir + string_node.token.str))
+        file_system_.remove(kWarmupDir + string_node.token.str);
     if (database_name_ == string_node.token.str)
     {
         database_schema_.clear();
@@ -263,7 +299,7 @@ void GDBE::execCreateTable(const Node &table_node)
     if (database_schema_.table_schema_map.find(table_name) != database_schema_.table_schema_map.end())
         throw Error(kTableExistError, table_name);
     TableSchema new_table_schema;
-    const Node &columns_node = table_node.children.back();
+    const Node &columns_node = table_node.children[1];
     for (const auto &node : columns_node.children)
     {
         if (node.token.token_type == kColumn)
@@ -276,11 +312,13 @@ void GDBE::execCreateTable(const Node &table_node)
                 new_column_schema.data_type = 0;
                 break;
             case kChar:
+            case kVarchar:
             {
                 if (node.children[1].children.empty())
                     new_column_schema.data_type = 1;
                 else
                     new_column_schema.data_type = node.children[1].children.front().token.num;
+                new_column_schema.varchar = node.children[1].token.token_type == kVarchar;
                 break;
             }
             default:
@@ -327,7 +365,9 @@ void GDBE::execCreateTable(const Node &table_node)
                     if (new_column_schema.index_schema.root_page_id == -1)
                     {
                         size_t index_size = new_column_schema.data_type == 0 ? kSizeOfLong + kSizeOfBool : new_column_schema.data_type + kSizeOfBool;
-                        PageSchema index_page_schema(true, 0, -1, -1, index_size + kSizeOfSizeT, index_size, kSizeOfSizeT, !new_column_schema.data_type);
+                        if (dataOverFlow(index_size + kSizeOfSizeT, kSizeOfSizeT))
+                            throw Error(kDataOverFlowError, "");
+                        PageSchema index_page_schema(true, 0, -1, -1, index_size + kSizeOfSizeT, index_size, kSizeOfSizeT);
                         IndexSchema index_schema;
                         index_schema.column_name = column_name;
                         index_schema.root_page_id = createNewPage(index_page_schema);
@@ -335,6 +375,20 @@ void GDBE::execCreateTable(const Node &table_node)
                     }
                     break;
                 }
+                case kDictionary:
+                {
+                    if (new_column_schema.data_type == 0 || new_column_schema.varchar)
+                        throw Error(kOperationError, column_name);
+                    new_column_schema.dictionary = true;
+                    break;
+                }
+                case kZoneMap:
+                {
+                    if (new_column_schema.data_type != 0)
+                        throw Error(kOperationError, column_name);
+                    new_column_schema.zone_map = true;
+                    break;
+                }
                 default:
                     throw Error(kSyntaxTreeError, node.children.back().token.str);
                 }
@@ -405,7 +459,9 @@ void GDBE::execCreateTable(const Node &table_node)
             if (column_schema.index_schema.root_page_id == -1)
             {
                 size_t index_size = column_schema.data_type == 0 ? kSizeOfLong + kSizeOfBool : column_schema.data_type + kSizeOfBool;
-                PageSchema index_page_schema(true, 0, -1, -1, index_size + kSizeOfSizeT, index_size, kSizeOfSizeT, !column_schema.data_type);
+                if (dataOverFlow(index_size + kSizeOfSizeT, kSizeOfSizeT))
+                    throw Error(kDataOverFlowError, "");
+                PageSchema index_page_schema(true, 0, -1, -1, index_size + kSizeOfSizeT, index_size, kSizeOfSizeT);
                 IndexSchema index_schema;
                 index_schema.column_name = column_name;
                 index_schema.root_page_id = createNewPage(index_page_schema);
@@ -434,7 +490,9 @@ void GDBE::execCreateTable(const Node &table_node)
                 if (column_schema.index_schema.root_page_id == -1)
                 {
                     size_t index_size = column_schema.data_type == 0 ? kSizeOfLong + kSizeOfBool : column_schema.data_type + kSizeOfBool;
-                    PageSchema index_page_schema(true, 0, -1, -1, index_size + kSizeOfSizeT, index_size, kSizeOfSizeT, !column_schema.data_type);
+                    if (dataOverFlow(index_size + kSizeOfSizeT, kSizeOfSizeT))
+                        throw Error(kDataOverFlowError, "");
+                    PageSchema index_page_schema(true, 0, -1, -1, index_size + kSizeOfSizeT, index_size, kSizeOfSizeT);
                     IndexSchema index_schema;
                     index_schema.column_name = column_name;
                     index_schema.root_page_id = createNewPage(index_page_schema);
@@ -444,13 +502,72 @@ void GDBE::execCreateTable(const Node &table_node)
         }
     }
     new_table_schema.max_id = 0;
+    for (size_t i = 2; i < table_node.children.size(); ++i)
+    {
+        switch (table_node.children[i].token.token_type)
+        {
+        case kClustered:
+        {
+            if (new_table_schema.primary_set.size() != 1 || new_table_schema.column_schema_map[*new_table_schema.primary_set.begin()].data_type != 0)
+                throw Error(kOperationError, "");
+            new_table_schema.clustered = true;
+            break;
+        }
+        case kCompressed:
+            new_table_schema.compressed = true;
+            break;
+        case kEngine:
+            new_table_schema.columnar = true;
+            break;
+        default:
+            throw Error(kSyntaxTreeError, table_node.children[i].token.str);
+        }
+    }
+    // A table with a VARCHAR column keeps its rows in slotted leaves: an entry
+    // is the key and a slot, and the row goes to the heap of the page with a
+    // copy of its key. The largest such entry must still fit the page.
+    bool slotted = false;
+    for (auto &&i : new_table_schema.column_schema_map)
+        slotted |= i.second.varchar;
     size_t value_size = getValueSize(new_table_schema.column_schema_map);
-    if (dataOverFlow(kSizeOfSizeT + kSizeOfBool, value_size))
+    // A COLUMNAR table keeps only the row keys in its table tree and each
+    // column in a tree of its own. VARCHAR columns are kept out of it.
+    if (new_table_schema.columnar)
+    {
+        if (slotted)
+            throw Error(kOperationError, "");
+        value_size = 0;
+        for (auto &&i : new_table_schema.column_schema_map)
+        {
+            if (dataOverFlow(kSizeOfSizeT + kSizeOfBool, columnValueSize(i.second)))
+                throw Error(kDataOverFlowError, "");
+        }
+        for (auto &&i : new_table_schema.column_order_vector)
+        {
+            ColumnSchema &column_schema = new_table_schema.column_schema_map[i];
+            column_schema.column_tree_id = ++database_schema_.max_tree_id;
+            PageSchema column_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, columnValueSize(column_schema), column_schema.column_tree_id);
+            column_schema.column_root_page_id = createNewPage(column_page_schema);
+        }
+    }
+    if (dataOverFlow(kSizeOfSizeT + kSizeOfBool, slotted ? kSizeOfSlot + kSizeOfSizeT + kSizeOfBool + value_size : value_size))
         throw Error(kDataOverFlowError, "");
-    PageSchema new_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, value_size, true);
+    new_table_schema.tree_id = ++database_schema_.max_tree_id;
+    PageSchema new_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, slotted ? kSizeOfSlot : value_size, new_table_schema.tree_id);
+    if (slotted)
+        new_page_schema.heap_size = 0;
 
     new_table_schema.root_page_id = createNewPage(new_page_schema);
+    if (!zoneColumnVector(new_table_schema).empty())
+    {
+        if (dataOverFlow(kSizeOfSizeT + kSizeOfBool, zoneValueSize(new_table_schema)))
+            throw Error(kDataOverFlowError, "");
+        PageSchema zone_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, zoneValueSize(new_table_schema));
+        new_table_schema.zone_root_page_id = createNewPage(zone_page_schema);
+        initZoneTree(new_table_schema);
+    }
     database_schema_.table_schema_map[table_name] = new_table_schema;
+    setCompressedTrees();
     updateDatabaseSchema();
     result_.type = kCreateTableResult;
 }
@@ -504,7 +621,14 @@ void GDBE::execDropTable(const Node &table_node)
         }
     }
     size_t page_id = table_iter->second.root_page_id;
+    freeTableOverflow(table_iter->second);
     BPlusTreeRemove(page_id);
+    for (auto &&i : table_iter->second.column_schema_map)
+    {
+        if (i.second.column_root_page_id != -1)
+            BPlusTreeRemove(i.second.column_root_page_id);
+    }
+    BPlusTreeRemove(table_iter->second.zone_root_page_id);
     database_schema_.table_schema_map.erase(table_iter->first);
     updateDatabaseSchema();
     result_.type = kDropTableResult;
@@ -551,8 +675,7 @@ void GDBE::execInsert(Node &insert_node)
             throw Error(kColumnCountNotMatchError, std::to_string(row));
         std::vector<Token> values;
         std::unordered_map<std::string, std::unordered_map<std::string, Token>> table_column_value_map;
-        std::vector<size_t> values_size;
-        size_t id = table_schema_iter->second.max_id++;
+        size_t id = table_schema_iter->second.clustered ? 0 : table_schema_iter->second.max_id++;
         for (auto &expr_node : exprs_node.children)
         {
             check(expr_node.children.front(), table_name_set, database_name_, database_schema_);
@@ -595,7 +718,6 @@ void GDBE::execInsert(Node &insert_node)
                 convertString(result_node.token);
             }
             values.push_back(result_node.token);
-            values_size.push_back(column_schema.data_type);
             table_column_value_map[table_name][column_name] = result_node.token;
         }
         for (auto &&i : table_column_value_map[table_name])
@@ -603,7 +725,7 @@ void GDBE::execInsert(Node &insert_node)
             const auto &column_schema = table_schema_iter->second.column_schema_map[i.first];
             size_t size = column_schema.data_type == 0 ? kSizeOfLong : column_schema.data_type;
             char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
-            serilization({i.second}, {size}, key);
+            serializeKey(i.second, size, key);
             if (column_schema.unique)
             {
                 if (BPlusTreeSearch(column_schema.index_schema.root_page_id, key, true))
@@ -617,6 +739,11 @@ void GDBE::execInsert(Node &insert_node)
                 delete[] key;
                 throw Error(kColumnNotNullError, i.first);
             }
+            if (column_schema.dictionary && i.second.token_type != kNull && column_schema.dictionary_vector.size() == kMaxDictionarySize && dictionaryCode(column_schema, i.second.str.substr(0, column_schema.data_type)) == -1)
+            {
+                delete[] key;
+                throw Error(kDataOverFlowError, "");
+            }
             if (!column_schema.reference_column_name.empty())
             {
                 TableSchema reference_table_schema = database_schema_.table_schema_map[column_schema.reference_table_name];
@@ -629,16 +756,27 @@ void GDBE::execInsert(Node &insert_node)
             }
             delete[] key;
         }
+        if (table_schema_iter->second.clustered)
+            id = table_column_value_map[table_name][*table_schema_iter->second.primary_set.begin()].num;
         char *key_ptr = new char[kSizeOfSizeT + kSizeOfBool];
-        bool null = false;
-        std::copy(reinterpret_cast<const char *>(&null), reinterpret_cast<const char *>(&null) + kSizeOfBool, key_ptr);
-        std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, key_ptr + kSizeOfBool);
+        serializeRowKey(id, key_ptr);
         size_t size = getValueSize(table_schema_iter->second.column_schema_map);
         char *values_ptr = new char[size];
-        serilization(values, values_size, values_ptr);
+        // Codes are only handed out once every check has passed, so a
+        // rejected row leaves nothing behind in a dictionary.
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            ColumnSchema &column_schema = table_schema_iter->second.column_schema_map[table_schema_iter->second.column_order_vector[i]];
+            if (column_schema.dictionary && values[i].token_type != kNull)
+                addDictionaryValue(column_schema, values[i].str.substr(0, column_schema.data_type));
+        }
+        size_t row_size = table_schema_iter->second.columnar ? 0 : serializeRow(values, table_schema_iter->second, values_ptr);
         size_t root_page_id = table_schema_iter->second.root_page_id;
-        BPlusTreeInsert(root_page_id, key_ptr, values_ptr, false, &root_page_id);
+        size_t row_page_id = BPlusTreeInsert(root_page_id, key_ptr, values_ptr, false, &root_page_id, row_size);
         database_schema_.table_schema_map[table_name].root_page_id = root_page_id;
+        if (table_schema_iter->second.columnar)
+            insertColumns(table_schema_iter->second, key_ptr, values);
+        insertZone(table_schema_iter->second, key_ptr, values);
         for (auto &&i : table_column_value_map[table_name])
         {
             auto &column_schema = table_schema_iter->second.column_schema_map[i.first];
@@ -649,9 +787,9 @@ void GDBE::execInsert(Node &insert_node)
                 char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
                 char *value = new char[kSizeOfSizeT];
                 size_t index_page_id = database_schema_.table_schema_map[table_name].column_schema_map[i.first].index_schema.root_page_id;
-                serilization({i.second}, {size}, key);
-                std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, key + size + kSizeOfBool);
-                std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, value);
+                serializeKey(i.second, size, key);
+                serializeId(id, key + size + kSizeOfBool);
+                std::copy(reinterpret_cast<const char *>(&row_page_id), reinterpret_cast<const char *>(&row_page_id) + kSizeOfSizeT, value);
                 BPlusTreeInsert(index_schema.root_page_id, key, value, false, &index_page_id);
                 database_schema_.table_schema_map[table_name].column_schema_map[i.first].index_schema.root_page_id = index_page_id;
                 delete[] key;
@@ -672,9 +810,9 @@ void GDBE::execInsert(Node &insert_node)
                         char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
                         char *value = new char[kSizeOfSizeT];
                         size_t index_page_id = database_schema_.table_schema_map[table_name].index_schema_map[{i.first}][index_pair.first].root_page_id;
-                        serilization({i.second}, {size}, key);
-                        std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, key + size + kSizeOfBool);
-                        std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, value);
+                        serializeKey(i.second, size, key);
+                        serializeId(id, key + size + kSizeOfBool);
+                        std::copy(reinterpret_cast<const char *>(&row_page_id), reinterpret_cast<const char *>(&row_page_id) + kSizeOfSizeT, value);
                         BPlusTreeInsert(index_page_id, key, value, false, &index_page_id);
                         database_schema_.table_schema_map[table_name].index_schema_map[{i.first}][index_pair.first].root_page_id = index_page_id;
                         delete[] key;
@@ -810,17 +948,25 @@ void GDBE::execSelect(Node &select_node)
             result_.type = kNoneResult;
             return;
         }
-        selectRecursive(table_index_condition_map, table_condition_map, select_table_name_set, select_expr_node_vector, limit);
+        // Only the columns the query uses are read from overflow pages.
+        std::unordered_map<std::string, std::unordered_set<std::string>> table_column_set_map;
+        for (auto &&i : select_table_name_set)
+            table_column_set_map[i];
+        for (auto &&i : select_expr_node_vector)
+            getColumnSet(i, &table_column_set_map);
+        for (auto &&i : condition_vector)
+            getColumnSet(i, &table_column_set_map);
+        selectRecursive(table_index_condition_map, table_condition_map, select_table_name_set, select_expr_node_vector, limit, table_column_set_map);
         result_.type = kSelectResult;
     }
 }
 
-void GDBE::selectRecursive(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition_map, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, const std::unordered_set<std::string> &select_table_name_set, const std::vector<Node> &select_expr_vector, size_t limit)
+void GDBE::selectRecursive(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition_map, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, const std::unordered_set<std::string> &select_table_name_set, const std::vector<Node> &select_expr_vector, size_t limit, const std::unordered_map<std::string, std::unordered_set<std::string>> &table_column_set_map)
 {
-    selectRecursiveAux(table_index_condition_map, table_condition_map, select_table_name_set, {}, {}, select_expr_vector, limit);
+    selectRecursiveAux(table_index_condition_map, table_condition_map, select_table_name_set, {}, {}, select_expr_vector, limit, table_column_set_map);
 }
 
-void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition_map, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, std::unordered_set<std::string> remain_table_name_set, std::unordered_set<std::string> already_table_name_set, std::unordered_map<std::string, std::unordered_map<std::string, Token>> table_column_map, const std::vector<Node> &select_expr_vector, size_t limit)
+void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition_map, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, std::unordered_set<std::string> remain_table_name_set, std::unordered_set<std::string> already_table_name_set, std::unordered_map<std::string, std::unordered_map<std::string, Token>> table_column_map, const std::vector<Node> &select_expr_vector, size_t limit, const std::unordered_map<std::string, std::unordered_set<std::string>> &table_column_set_map)
 {
     if (result_.count == limit)
         return;
@@ -830,8 +976,15 @@ void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<In
         remain_table_name_set.erase(remain_table_name_set.begin());
         already_table_name_set.insert(table_name);
         const TableSchema &table_schema = database_schema_.table_schema_map[table_name];
+        std::vector<DictionaryFilter> dictionary_filter_vector;
+        std::vector<ZoneFilter> zone_filter_vector;
+        const auto &condition_iter = table_condition_map.find({table_name});
+        if (condition_iter != table_condition_map.end() && (!dictionaryFilter(table_schema, condition_iter->second, &dictionary_filter_vector) || !zoneFilter(table_schema, condition_iter->second, &zone_filter_vector)))
+            return;
         const auto &index_condition_map_iter = table_index_condition_map.find(table_name);
-        if (index_condition_map_iter != table_index_condition_map.end() && index_condition_map_iter->second.first.root_page_id != -1)
+        char *scan_begin_key = nullptr, *scan_end_key = nullptr;
+        bool clustered_range = index_condition_map_iter != table_index_condition_map.end() && clusteredRange(table_schema, index_condition_map_iter->second, &scan_begin_key, &scan_end_key);
+        if (!clustered_range && index_condition_map_iter != table_index_condition_map.end() && index_condition_map_iter->second.first.root_page_id != -1)
         {
             std::pair<IndexSchema, std::pair<Token, Token>> index_condition = index_condition_map_iter->second;
             std::pair<Token, Token> condition = index_condition.second;
@@ -855,74 +1008,98 @@ void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<In
             if (condition.first)
             {
                 begin_key = new char[size + kSizeOfBool];
-                serilization({condition.first}, {size}, begin_key);
+                serializeKey(condition.first, size, begin_key);
             }
             if (condition.second)
             {
                 end_key = new char[size + kSizeOfBool];
-                serilization({condition.second}, {size}, end_key);
+                serializeKey(condition.second, size, end_key);
             }
             size_t index_page_id = index_schema.root_page_id;
-            PageSchema temp_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, 0, true);
+            PageSchema temp_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT);
             size_t temp_page_id = createNewPage(temp_page_schema);
             char *temp_key = new char[kSizeOfSizeT + kSizeOfBool];
-            bool null = false;
             for (auto &&i : BPlusTreeSelect(index_page_id, begin_key, end_key, true))
             {
-                size_t id = *reinterpret_cast<const size_t *>(i + size + kSizeOfBool + kSizeOfSizeT);
-                std::copy(reinterpret_cast<const char *>(&null), reinterpret_cast<const char *>(&null) + kSizeOfBool, temp_key);
-                std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, temp_key + kSizeOfBool);
-                BPlusTreeInsert(temp_page_id, temp_key, nullptr, true, &temp_page_id);
+                size_t id = deserializeId(i + size + kSizeOfBool);
+                serializeRowKey(id, temp_key);
+                BPlusTreeInsert(temp_page_id, temp_key, i + size + kSizeOfBool + kSizeOfSizeT, true, &temp_page_id);
             }
             delete[] temp_key;
-            for (auto &&id_iter : BPlusTreeSelect(temp_page_id, nullptr, nullptr, false))
+            Iterator id_iterator = BPlusTreeSelect(temp_page_id, nullptr, nullptr, false);
+            Iter id_iter_end = id_iterator.end();
+            std::vector<char> key_buffer;
+            std::vector<char *> key_vector;
+            std::vector<size_t> hint_vector;
+            for (Iter id_iter_begin = id_iterator.begin(); nextKeyBatch(id_iter_begin, id_iter_end, kSizeOfSizeT + kSizeOfBool + kSizeOfSizeT, key_buffer, key_vector);)
             {
-                size_t id = *reinterpret_cast<const size_t *>(id_iter + kSizeOfBool);
-                bool is_true = true;
-                char *iter = BPlusTreeSearch(table_schema.root_page_id, id_iter, false);
-                std::unordered_map<std::string, Token> column_token_map = toTokenMap(iter, table_schema, size, &id);
-                table_column_map[table_name] = column_token_map;
-                for (const auto &i : table_condition_map)
+                hint_vector.clear();
+                for (auto &&key : key_vector)
+                    hint_vector.push_back(*reinterpret_cast<const size_t *>(key + kSizeOfSizeT + kSizeOfBool));
+                std::vector<RecordPtr> record_vector = BPlusTreeMultiSearch(table_schema.root_page_id, key_vector, false, &hint_vector);
+                std::vector<std::unordered_map<std::string, Token>> column_map_vector;
+                if (table_schema.columnar)
+                    column_map_vector = columnTokenMaps(table_schema, key_vector, &table_column_set_map.at(table_name));
+                column_map_vector.resize(key_vector.size());
+                std::vector<bool> match_vector(key_vector.size());
+                for (size_t k = 0; k < key_vector.size(); ++k)
+                {
+                    match_vector[k] = matchDictionaryFilter(record_vector[k], dictionary_filter_vector);
+                    size_t id;
+                    if (match_vector[k] && !table_schema.columnar)
+                        column_map_vector[k] = toTokenMap(record_vector[k], table_schema, size, &id, &table_column_set_map.at(table_name));
+                }
+                // The batch is decoded and unpinned before the next table of
+                // the join pins a batch of its own.
+                record_vector.clear();
+                for (size_t k = 0; k < key_vector.size(); ++k)
                 {
-                    if (i.first.find(table_name) == i.first.end())
+                    bool is_true = true;
+                    if (!match_vector[k])
                         continue;
-                    else
+                    table_column_map[table_name] = std::move(column_map_vector[k]);
+                    for (const auto &i : table_condition_map)
                     {
-                        bool flag = true;
-                        for (const auto &j : i.first)
+                        if (i.first.find(table_name) == i.first.end())
+                            continue;
+                        else
                         {
-                            if (already_table_name_set.find(j) == already_table_name_set.end())
+                            bool flag = true;
+                            for (const auto &j : i.first)
                             {
-                                flag = false;
-                                break;
+                                if (already_table_name_set.find(j) == already_table_name_set.end())
+                                {
+                                    flag = false;
+                                    break;
+                                }
                             }
-                        }
-                        if (flag)
-                        {
-                            for (const auto &r : i.second)
+                            if (flag)
                             {
-                                Node result_node = eval(r, table_column_map, false);
-                                if (result_node.token.token_type != kNum || !result_node.token.num)
+                                for (const auto &r : i.second)
                                 {
-                                    is_true = false;
-                                    break;
+                                    Node result_node = eval(r, table_column_map, false);
+                                    if (result_node.token.token_type != kNum || !result_node.token.num)
+                                    {
+                                        is_true = false;
+                                        break;
+                                    }
                                 }
                             }
                         }
+                        if (!is_true)
+                            break;
+                    }
+                    if (is_true)
+                        selectRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, select_expr_vector, limit, table_column_set_map);
+                    if (result_.count == limit)
+                    {
+                        BPlusTreeRemove(temp_page_id);
+                        if (begin_key)
+                            delete[] begin_key;
+                        if (end_key)
+                            delete[] end_key;
+                        return;
                     }
-                    if (!is_true)
-                        break;
-                }
-                if (is_true)
-                    selectRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, select_expr_vector, limit);
-                if (result_.count == limit)
-                {
-                    BPlusTreeRemove(temp_page_id);
-                    if (begin_key)
-                        delete[] begin_key;
-                    if (end_key)
-                        delete[] end_key;
-                    return;
                 }
             }
             BPlusTreeRemove(temp_page_id);
@@ -933,51 +1110,70 @@ void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<In
         }
         else
         {
-            for (auto &&iter : BPlusTreeSelect(table_schema.root_page_id, nullptr, nullptr, false))
+            for (auto &&zone_run : zoneRuns(table_schema, zone_filter_vector, scan_begin_key, scan_end_key))
             {
-                bool is_true = true;
-                size_t id = -1;
-                std::unordered_map<std::string, Token> column_token_map = toTokenMap(iter, table_schema, kSizeOfSizeT, &id);
-                table_column_map[table_name] = column_token_map;
-
-                for (const auto &i : table_condition_map)
+                char *run_begin_key = zone_run.first.empty() || (scan_begin_key && std::memcmp(scan_begin_key, zone_run.first.data(), kSizeOfBool + kSizeOfSizeT) > 0) ? scan_begin_key : &zone_run.first[0];
+                std::unique_ptr<ColumnCursor> column_cursor;
+                if (table_schema.columnar)
+                    column_cursor.reset(new ColumnCursor(table_schema, &table_column_set_map.at(table_name), run_begin_key, scan_end_key));
+                for (auto &&iter : BPlusTreeSelect(table_schema.root_page_id, run_begin_key, scan_end_key, false))
                 {
-                    if (i.first.find(table_name) == i.first.end())
+                    if (!zone_run.second.empty() && std::memcmp(iter, zone_run.second.data(), kSizeOfBool + kSizeOfSizeT) >= 0)
+                        break;
+                    if (!matchDictionaryFilter(iter, dictionary_filter_vector))
                         continue;
-                    else
+                    bool is_true = true;
+                    size_t id = -1;
+                    std::unordered_map<std::string, Token> column_token_map = column_cursor ? column_cursor->next() : toTokenMap(iter, table_schema, kSizeOfSizeT, &id, &table_column_set_map.at(table_name));
+                    table_column_map[table_name] = column_token_map;
+
+                    for (const auto &i : table_condition_map)
                     {
-                        bool flag = true;
-                        for (const auto &j : i.first)
+                        if (i.first.find(table_name) == i.first.end())
+                            continue;
+                        else
                         {
-                            if (already_table_name_set.find(j) == already_table_name_set.end())
+                            bool flag = true;
+                            for (const auto &j : i.first)
                             {
-                                flag = false;
-                                break;
+                                if (already_table_name_set.find(j) == already_table_name_set.end())
+                                {
+                                    flag = false;
+                                    break;
+                                }
                             }
-                        }
-                        if (flag)
-                        {
-                            for (const auto &r : i.second)
+                            if (flag)
                             {
-                                Node result_node = eval(r, table_column_map, false);
-                                if (result_node.token.token_type != kNum || !result_node.token.num)
+                                for (const auto &r : i.second)
                                 {
-                                    is_true = false;
-                                    break;
+                                    Node result_node = eval(r, table_column_map, false);
+                                    if (result_node.token.token_type != kNum || !result_node.token.num)
+                                    {
+                                        is_true = false;
+                                        break;
+                                    }
                                 }
                             }
                         }
+                        if (!is_true)
+                            break;
+                    }
+                    if (is_true)
+                        selectRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, select_expr_vector, limit, table_column_set_map);
+                    if (result_.count == limit)
+                    {
+                        if (scan_begin_key)
+                            delete[] scan_begin_key;
+                        if (scan_end_key)
+                            delete[] scan_end_key;
+                        return;
                     }
-                    if (!is_true)
-                        break;
-                }
-                if (is_true)
-                    selectRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, select_expr_vector, limit);
-                if (result_.count == limit)
-                {
-                    return;
                 }
             }
+            if (scan_begin_key)
+                delete[] scan_begin_key;
+            if (scan_end_key)
+                delete[] scan_end_key;
         }
     }
     else
@@ -986,17 +1182,28 @@ void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<In
         ++result_.count;
         if (result_.page_id == -1)
         {
+            // A string column keeps values up to the inline limit of the
+            // result row, and a longer one points at its table's overflow
+            // chain.
+            std::vector<size_t> width_vector;
             for (const auto &i : select_expr_vector)
             {
                 Node node = eval(i, table_column_map, false);
                 value.push_back(node.token);
                 int data_type = getExprDataType(i);
-                size_t temp = data_type == 0 ? kSizeOfLong : data_type;
-                result_.value_size_vector.push_back(temp);
                 result_.data_type_vector.push_back(data_type);
-                result_.total_size += kSizeOfBool + temp;
+                result_.total_size += kSizeOfBool + (data_type == 0 ? kSizeOfLong : 0);
+                if (data_type != 0)
+                    width_vector.push_back(data_type);
             }
-            PageSchema result_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, result_.total_size, true);
+            size_t row_size = (database_schema_.page_size - kOffsetOfPageHeader) / 3 - kSizeOfSizeT - kSizeOfBool;
+            size_t limit = inlineLimit(width_vector, row_size > result_.total_size ? row_size - result_.total_size : 0);
+            for (auto &&data_type : result_.data_type_vector)
+            {
+                result_.value_size_vector.push_back(data_type == 0 ? kSizeOfLong : std::min(static_cast<size_t>(data_type), limit));
+                result_.total_size += data_type == 0 ? 0 : result_.value_size_vector.back();
+            }
+            PageSchema result_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, result_.total_size);
             result_.page_id = createNewPage(result_page_schema);
         }
         else
@@ -1008,9 +1215,7 @@ void GDBE::selectRecursiveAux(const std::unordered_map<std::string, std::pair<In
             }
         }
         char *key_ptr = new char[kSizeOfSizeT + kSizeOfBool];
-        bool null = false;
-        std::copy(reinterpret_cast<const char *>(&null), reinterpret_cast<const char *>(&null) + kSizeOfBool, key_ptr);
-        std::copy(reinterpret_cast<const char *>(&result_.count), reinterpret_cast<const char *>(&result_.count) + kSizeOfSizeT, key_ptr + kSizeOfBool);
+        serializeRowKey(result_.count, key_ptr);
         char *values_ptr = new char[result_.total_size];
         serilization(value, result_.value_size_vector, values_ptr);
         size_t root_page_id = -1;
@@ -1114,6 +1319,13 @@ void GDBE::execDelete(Node &delete_node)
         {
             table_id_page_id_map[i] = -1;
         }
+        if (delete_table_name_set.size() == 1 && select_table_name_set.size() == 1 && isRangeDelete(*delete_table_name_set.begin(), table_condition_map, table_index_condition_map))
+        {
+            deleteRange(*delete_table_name_set.begin(), table_index_condition_map[*delete_table_name_set.begin()]);
+            updateDatabaseSchema();
+            result_.type = kDeleteResult;
+            return;
+        }
         bool null = false;
         deleteRecursive(table_index_condition_map, table_condition_map, select_table_name_set, delete_table_name_set, table_id_page_id_map);
         for (auto &&i : table_id_page_id_map)
@@ -1121,86 +1333,125 @@ void GDBE::execDelete(Node &delete_node)
             std::string table_name = i.first;
             size_t id_page_id = i.second;
             const TableSchema &table_schema = database_schema_.table_schema_map[table_name];
-            for (auto &&iter : BPlusTreeSelect(id_page_id, nullptr, nullptr, false))
-            {
-                char *mem = BPlusTreeSearch(database_schema_.table_schema_map[table_name].root_page_id, iter, false);
-                size_t id = -1;
-                auto column_map = toTokenMap(mem, table_schema, kSizeOfSizeT, &id);
-                for (auto &&pair : table_schema.column_schema_map)
-                {
-                    const ColumnSchema &column_schema = pair.second;
-                    if (!column_schema.be_reference_set.empty())
-                    {
-                        size_t size = column_schema.data_type ? column_schema.data_type : kSizeOfSizeT;
-                        char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
-                        for (auto &&i : column_schema.be_reference_set)
-                        {
-                            std::string reference_table_name = i.first;
-                            std::string reference_column_name = i.second;
-                            serilization({column_map[pair.first]}, {size - kSizeOfBool}, key);
-                            const IndexSchema &index_schema = database_schema_.table_schema_map[reference_table_name].column_schema_map[reference_column_name].index_schema;
-                            if (BPlusTreeSearch(index_schema.root_page_id, key, true))
-                            {
-                                delete[] key;
-                                for (auto &&i : table_id_page_id_map)
-                                {
-                                    BPlusTreeRemove(i.second);
-                                }
-                                throw Error(kForeignkeyConstraintError, "");
-                            }
-                        }
-                        delete[] key;
-                    }
-                }
-            }
+            Iterator id_iterator = BPlusTreeSelect(id_page_id, nullptr, nullptr, false);
+            Iter id_iter_end = id_iterator.end();
+            std::vector<char> key_buffer;
+            std::vector<char *> key_vector;
+            for (Iter id_iter_begin = id_iterator.begin(); nextKeyBatch(id_iter_begin, id_iter_end, kSizeOfSizeT + kSizeOfBool, key_buffer, key_vector);)
+                checkReferenceBatch(table_schema, key_vector, table_id_page_id_map);
         }
         for (auto &&i : table_id_page_id_map)
         {
             std::string table_name = i.first;
             size_t id_page_id = i.second;
-            const TableSchema &table_schema = database_schema_.table_schema_map[table_name];
-            for (auto &&iter : BPlusTreeSelect(id_page_id, nullptr, nullptr, false))
+            Iterator id_iterator = BPlusTreeSelect(id_page_id, nullptr, nullptr, false);
+            Iter id_iter_end = id_iterator.end();
+            std::vector<char> key_buffer;
+            std::vector<char *> key_vector;
+            for (Iter id_iter_begin = id_iterator.begin(); nextKeyBatch(id_iter_begin, id_iter_end, kSizeOfSizeT + kSizeOfBool, key_buffer, key_vector);)
+                deleteRowBatch(table_name, key_vector);
+        }
+        for (auto &&i : table_id_page_id_map)
+        {
+            BPlusTreeRemove(i.second);
+        }
+        updateDatabaseSchema();
+        result_.type = kDeleteResult;
+    }
+}
+
+// Decodes a batch of rows of table_schema, looked up with one
+// BPlusTreeMultiSearch, before any of them is modified. With free_overflow
+// the overflow chains of the rows are freed once they are read.
+std::vector<std::unordered_map<std::string, Token>> GDBE::readRowBatch(const TableSchema &table_schema, const std::vector<char *> &key_vector, bool free_overflow)
+{
+    if (table_schema.columnar)
+        return columnTokenMaps(table_schema, key_vector);
+    std::vector<std::unordered_map<std::string, Token>> column_map_vector;
+    bool overflow = free_overflow && hasOverflow(table_schema);
+    for (auto &&mem : BPlusTreeMultiSearch(table_schema.root_page_id, key_vector, false))
+    {
+        size_t id = -1;
+        column_map_vector.push_back(toTokenMap(mem, table_schema, kSizeOfSizeT, &id));
+        if (overflow)
+            freeRowOverflow(mem, table_schema);
+    }
+    return column_map_vector;
+}
+
+void GDBE::checkReferenceBatch(const TableSchema &table_schema, const std::vector<char *> &key_vector, std::unordered_map<std::string, size_t> &table_id_page_id_map)
+{
+    for (auto &&column_map : readRowBatch(table_schema, key_vector, false))
+    {
+        for (auto &&pair : table_schema.column_schema_map)
+        {
+            const ColumnSchema &column_schema = pair.second;
+            if (!column_schema.be_reference_set.empty())
             {
-                char *mem = BPlusTreeSearch(database_schema_.table_schema_map[table_name].root_page_id, iter, false);
-                size_t id = -1;
-                auto column_map = toTokenMap(mem, table_schema, kSizeOfSizeT, &id);
-                for (auto &&pair : table_schema.column_schema_map)
+                size_t size = column_schema.data_type ? column_schema.data_type : kSizeOfLong;
+                char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
+                for (auto &&i : column_schema.be_reference_set)
                 {
-                    const ColumnSchema &column_schema = pair.second;
-                    size_t size = column_schema.data_type ? column_schema.data_type : kSizeOfSizeT;
-                    char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
-                    serilization({column_map[pair.first]}, {size - kSizeOfBool}, key);
-                    size_t val = column_map[pair.first].num;
-                    std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, key + size + kSizeOfBool);
-                    if (column_schema.index_schema.root_page_id != -1)
-                    {
-                        size_t root_page_id = column_schema.index_schema.root_page_id;
-                        BPlusTreeDelete(root_page_id, key, &root_page_id);
-                        database_schema_.table_schema_map[table_name].column_schema_map[pair.first].index_schema.root_page_id = root_page_id;
-                    }
-                    if (database_schema_.table_schema_map[table_name].index_schema_map.find({pair.first}) != database_schema_.table_schema_map[table_name].index_schema_map.end())
+                    std::string reference_table_name = i.first;
+                    std::string reference_column_name = i.second;
+                    serializeKey(column_map[pair.first], size, key);
+                    const IndexSchema &index_schema = database_schema_.table_schema_map[reference_table_name].column_schema_map[reference_column_name].index_schema;
+                    if (BPlusTreeSearch(index_schema.root_page_id, key, true))
                     {
-                        for (auto &&index_schema_pair : database_schema_.table_schema_map[table_name].index_schema_map[{pair.first}])
+                        delete[] key;
+                        for (auto &&i : table_id_page_id_map)
                         {
-                            auto &index_schema = index_schema_pair.second;
-                            size_t root_page_id = index_schema.root_page_id;
-                            BPlusTreeDelete(root_page_id, key, &root_page_id);
-                            database_schema_.table_schema_map[table_name].index_schema_map[{pair.first}][index_schema_pair.first].root_page_id = root_page_id;
+                            BPlusTreeRemove(i.second);
                         }
+                        throw Error(kForeignkeyConstraintError, "");
                     }
-                    delete[] key;
                 }
-                size_t page_id = database_schema_.table_schema_map[table_name].root_page_id;
-                BPlusTreeDelete(page_id, iter, &page_id);
-                database_schema_.table_schema_map[table_name].root_page_id = page_id;
+                delete[] key;
             }
         }
-        for (auto &&i : table_id_page_id_map)
+    }
+}
+
+void GDBE::deleteRowBatch(const std::string &table_name, const std::vector<char *> &key_vector)
+{
+    const TableSchema &table_schema = database_schema_.table_schema_map[table_name];
+    std::vector<std::unordered_map<std::string, Token>> column_map_vector = readRowBatch(table_schema, key_vector, true);
+    for (size_t k = 0; k < key_vector.size(); ++k)
+    {
+        char *iter = key_vector[k];
+        size_t id = deserializeId(iter + kSizeOfBool);
+        auto &column_map = column_map_vector[k];
+        for (auto &&pair : table_schema.column_schema_map)
         {
-            BPlusTreeRemove(i.second);
+            const ColumnSchema &column_schema = pair.second;
+            size_t size = column_schema.data_type ? column_schema.data_type : kSizeOfLong;
+            char *key = new char[size + kSizeOfBool + kSizeOfSizeT];
+            serializeKey(column_map[pair.first], size, key);
+            serializeId(id, key + size + kSizeOfBool);
+            if (column_schema.index_schema.root_page_id != -1)
+            {
+                size_t root_page_id = column_schema.index_schema.root_page_id;
+                BPlusTreeDelete(root_page_id, key, &root_page_id);
+                database_schema_.table_schema_map[table_name].column_schema_map[pair.first].index_schema.root_page_id = root_page_id;
+            }
+            if (database_schema_.table_schema_map[table_name].index_schema_map.find({pair.first}) != database_schema_.table_schema_map[table_name].index_schema_map.end())
+            {
+                for (auto &&index_schema_pair : database_schema_.table_schema_map[table_name].index_schema_map[{pair.first}])
+                {
+                    auto &index_schema = index_schema_pair.second;
+                    size_t root_page_id = index_schema.root_page_id;
+                    BPlusTreeDelete(root_page_id, key, &root_page_id);
+                    database_schema_.table_schema_map[table_name].index_schema_map[{pair.first}][index_schema_pair.first].root_page_id = root_page_id;
+                }
+            }
+            delete[] key;
         }
-        updateDatabaseSchema();
-        result_.type = kDeleteResult;
+        size_t page_id = database_schema_.table_schema_map[table_name].root_page_id;
+        BPlusTreeDelete(page_id, iter, &page_id);
+        database_schema_.table_schema_map[table_name].root_page_id = page_id;
+        if (table_schema.columnar)
+            deleteColumns(database_schema_.table_schema_map[table_name], iter);
+        deleteZone(database_schema_.table_schema_map[table_name], iter);
     }
 }
 
@@ -1217,8 +1468,15 @@ void GDBE::deleteRecursiveAux(const std::unordered_map<std::string, std::pair<In
         remain_table_name_set.erase(remain_table_name_set.begin());
         already_table_name_set.insert(table_name);
         const TableSchema &table_schema = database_schema_.table_schema_map[table_name];
+        std::vector<DictionaryFilter> dictionary_filter_vector;
+        std::vector<ZoneFilter> zone_filter_vector;
+        const auto &condition_iter = table_condition_map.find({table_name});
+        if (condition_iter != table_condition_map.end() && (!dictionaryFilter(table_schema, condition_iter->second, &dictionary_filter_vector) || !zoneFilter(table_schema, condition_iter->second, &zone_filter_vector)))
+            return;
         const auto &index_condition_map_iter = table_index_condition_map.find(table_name);
-        if (index_condition_map_iter != table_index_condition_map.end() && index_condition_map_iter->second.first.root_page_id != -1)
+        char *scan_begin_key = nullptr, *scan_end_key = nullptr;
+        bool clustered_range = index_condition_map_iter != table_index_condition_map.end() && clusteredRange(table_schema, index_condition_map_iter->second, &scan_begin_key, &scan_end_key);
+        if (!clustered_range && index_condition_map_iter != table_index_condition_map.end() && index_condition_map_iter->second.first.root_page_id != -1)
         {
             std::pair<IndexSchema, std::pair<Token, Token>> index_condition = index_condition_map_iter->second;
             std::pair<Token, Token> condition = index_condition.second;
@@ -1242,67 +1500,91 @@ void GDBE::deleteRecursiveAux(const std::unordered_map<std::string, std::pair<In
             if (condition.first)
             {
                 begin_key = new char[size + kSizeOfBool];
-                serilization({condition.first}, {size}, begin_key);
+                serializeKey(condition.first, size, begin_key);
             }
             if (condition.second)
             {
                 end_key = new char[size + kSizeOfBool];
-                serilization({condition.second}, {size}, end_key);
+                serializeKey(condition.second, size, end_key);
             }
             size_t index_page_id = index_schema.root_page_id;
-            PageSchema temp_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, 0, false);
+            PageSchema temp_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT);
             size_t temp_page_id = createNewPage(temp_page_schema);
             char *temp_key = new char[kSizeOfSizeT + kSizeOfBool];
-            bool null = false;
             for (auto &&i : BPlusTreeSelect(index_page_id, begin_key, end_key, true))
             {
-                size_t id = *reinterpret_cast<const size_t *>(i + size + kSizeOfBool + kSizeOfSizeT);
-                std::copy(reinterpret_cast<const char *>(&null), reinterpret_cast<const char *>(&null) + kSizeOfBool, temp_key);
-                std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, temp_key + kSizeOfBool);
-                BPlusTreeInsert(temp_page_id, temp_key, nullptr, true, &temp_page_id);
+                size_t id = deserializeId(i + size + kSizeOfBool);
+                serializeRowKey(id, temp_key);
+                BPlusTreeInsert(temp_page_id, temp_key, i + size + kSizeOfBool + kSizeOfSizeT, true, &temp_page_id);
             }
             delete[] temp_key;
-            for (auto &&id_iter : BPlusTreeSelect(temp_page_id, nullptr, nullptr, false))
+            Iterator id_iterator = BPlusTreeSelect(temp_page_id, nullptr, nullptr, false);
+            Iter id_iter_end = id_iterator.end();
+            std::vector<char> key_buffer;
+            std::vector<char *> key_vector;
+            std::vector<size_t> hint_vector;
+            for (Iter id_iter_begin = id_iterator.begin(); nextKeyBatch(id_iter_begin, id_iter_end, kSizeOfSizeT + kSizeOfBool + kSizeOfSizeT, key_buffer, key_vector);)
             {
-                size_t id = *reinterpret_cast<const size_t *>(id_iter + kSizeOfBool);
-                bool is_true = true;
-                char *iter = BPlusTreeSearch(table_schema.root_page_id, id_iter, false);
-                std::unordered_map<std::string, Token> column_token_map = toTokenMap(iter, table_schema, size, &id);
-                table_id_map[table_name] = id;
-                table_column_map[table_name] = column_token_map;
-                for (const auto &i : table_condition_map)
+                hint_vector.clear();
+                for (auto &&key : key_vector)
+                    hint_vector.push_back(*reinterpret_cast<const size_t *>(key + kSizeOfSizeT + kSizeOfBool));
+                std::vector<RecordPtr> record_vector = BPlusTreeMultiSearch(table_schema.root_page_id, key_vector, false, &hint_vector);
+                std::vector<std::unordered_map<std::string, Token>> column_map_vector;
+                if (table_schema.columnar)
+                    column_map_vector = columnTokenMaps(table_schema, key_vector);
+                column_map_vector.resize(key_vector.size());
+                std::vector<bool> match_vector(key_vector.size());
+                for (size_t k = 0; k < key_vector.size(); ++k)
+                {
+                    match_vector[k] = matchDictionaryFilter(record_vector[k], dictionary_filter_vector);
+                    size_t id;
+                    if (match_vector[k] && !table_schema.columnar)
+                        column_map_vector[k] = toTokenMap(record_vector[k], table_schema, size, &id);
+                }
+                // The batch is decoded and unpinned before the next table of
+                // the join pins a batch of its own.
+                record_vector.clear();
+                for (size_t k = 0; k < key_vector.size(); ++k)
                 {
-                    if (i.first.find(table_name) == i.first.end())
+                    bool is_true = true;
+                    if (!match_vector[k])
                         continue;
-                    else
+                    table_id_map[table_name] = deserializeId(key_vector[k] + kSizeOfBool);
+                    table_column_map[table_name] = std::move(column_map_vector[k]);
+                    for (const auto &i : table_condition_map)
                     {
-                        bool flag = true;
-                        for (const auto &j : i.first)
+                        if (i.first.find(table_name) == i.first.end())
+                            continue;
+                        else
                         {
-                            if (already_table_name_set.find(j) == already_table_name_set.end())
+                            bool flag = true;
+                            for (const auto &j : i.first)
                             {
-                                flag = false;
-                                break;
+                                if (already_table_name_set.find(j) == already_table_name_set.end())
+                                {
+                                    flag = false;
+                                    break;
+                                }
                             }
-                        }
-                        if (flag)
-                        {
-                            for (const auto &r : i.second)
+                            if (flag)
                             {
-                                Node result_node = eval(r, table_column_map, false);
-                                if (result_node.token.token_type != kNum || !result_node.token.num)
+                                for (const auto &r : i.second)
                                 {
-                                    is_true = false;
-                                    break;
+                                    Node result_node = eval(r, table_column_map, false);
+                                    if (result_node.token.token_type != kNum || !result_node.token.num)
+                                    {
+                                        is_true = false;
+                                        break;
+                                    }
                                 }
                             }
                         }
+                        if (!is_true)
+                            break;
                     }
-                    if (!is_true)
-                        break;
+                    if (is_true)
+                        deleteRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, delete_table_name_set, table_id_page_id_map, table_id_map);
                 }
-                if (is_true)
-                    deleteRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, delete_table_name_set, table_id_page_id_map, table_id_map);
             }
             BPlusTreeRemove(temp_page_id);
             if (begin_key)
@@ -1312,67 +1594,80 @@ void GDBE::deleteRecursiveAux(const std::unordered_map<std::string, std::pair<In
         }
         else
         {
-            for (auto &&iter : BPlusTreeSelect(table_schema.root_page_id, nullptr, nullptr, false))
+            for (auto &&zone_run : zoneRuns(table_schema, zone_filter_vector, scan_begin_key, scan_end_key))
             {
-                bool is_true = true;
-                size_t id = -1;
-                std::unordered_map<std::string, Token> column_token_map = toTokenMap(iter, table_schema, kSizeOfSizeT, &id);
-                table_id_map[table_name] = id;
-                table_column_map[table_name] = column_token_map;
-
-                for (const auto &i : table_condition_map)
+                char *run_begin_key = zone_run.first.empty() || (scan_begin_key && std::memcmp(scan_begin_key, zone_run.first.data(), kSizeOfBool + kSizeOfSizeT) > 0) ? scan_begin_key : &zone_run.first[0];
+                std::unique_ptr<ColumnCursor> column_cursor;
+                if (table_schema.columnar)
+                    column_cursor.reset(new ColumnCursor(table_schema, nullptr, run_begin_key, scan_end_key));
+                for (auto &&iter : BPlusTreeSelect(table_schema.root_page_id, run_begin_key, scan_end_key, false))
                 {
-                    if (i.first.find(table_name) == i.first.end())
+                    if (!zone_run.second.empty() && std::memcmp(iter, zone_run.second.data(), kSizeOfBool + kSizeOfSizeT) >= 0)
+                        break;
+                    if (!matchDictionaryFilter(iter, dictionary_filter_vector))
                         continue;
-                    else
+                    bool is_true = true;
+                    size_t id = column_cursor ? deserializeId(iter + kSizeOfBool) : -1;
+                    std::unordered_map<std::string, Token> column_token_map = column_cursor ? column_cursor->next() : toTokenMap(iter, table_schema, kSizeOfSizeT, &id);
+                    table_id_map[table_name] = id;
+                    table_column_map[table_name] = column_token_map;
+
+                    for (const auto &i : table_condition_map)
                     {
-                        bool flag = true;
-                        for (const auto &j : i.first)
+                        if (i.first.find(table_name) == i.first.end())
+                            continue;
+                        else
                         {
-                            if (already_table_name_set.find(j) == already_table_name_set.end())
+                            bool flag = true;
+                            for (const auto &j : i.first)
                             {
-                                flag = false;
-                                break;
+                                if (already_table_name_set.find(j) == already_table_name_set.end())
+                                {
+                                    flag = false;
+                                    break;
+                                }
                             }
-                        }
-                        if (flag)
-                        {
-                            for (const auto &r : i.second)
+                            if (flag)
                             {
-                                Node result_node = eval(r, table_column_map, false);
-                                if (result_node.token.token_type != kNum || !result_node.token.num)
+                                for (const auto &r : i.second)
                                 {
-                                    is_true = false;
-                                    break;
+                                    Node result_node = eval(r, table_column_map, false);
+                                    if (result_node.token.token_type != kNum || !result_node.token.num)
+                                    {
+                                        is_true = false;
+                                        break;
+                                    }
                                 }
                             }
                         }
+                        if (!is_true)
+                            break;
                     }
-                    if (!is_true)
-                        break;
+                    if (is_true)
+                        deleteRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, delete_table_name_set, table_id_page_id_map, table_id_map);
                 }
-                if (is_true)
-                    deleteRecursiveAux(table_index_condition_map, table_condition_map, remain_table_name_set, already_table_name_set, table_column_map, delete_table_name_set, table_id_page_id_map, table_id_map);
             }
+            if (scan_begin_key)
+                delete[] scan_begin_key;
+            if (scan_end_key)
+                delete[] scan_end_key;
         }
     }
     else
     {
         if (table_id_page_id_map.begin()->second == -1)
         {
-            PageSchema id_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, 0, true);
+            PageSchema id_page_schema(true, 0, -1, -1, kSizeOfSizeT + kSizeOfBool, kSizeOfSizeT + kSizeOfBool, 0);
             for (auto &&i : table_id_page_id_map)
             {
                 i.second = createNewPage(id_page_schema);
             }
         }
         char *id_ptr = new char[kSizeOfSizeT + kSizeOfBool];
-        bool null = false;
         for (auto &&i : table_id_page_id_map)
         {
             size_t id = table_id_map[i.first];
-            std::copy(reinterpret_cast<const char *>(&null), reinterpret_cast<const char *>(&null) + kSizeOfBool, id_ptr);
-            std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, id_ptr + kSizeOfBool);
+            serializeRowKey(id, id_ptr);
             size_t root_page_id = table_id_page_id_map[i.first];
             BPlusTreeInsert(root_page_id, id_ptr, nullptr, true, &root_page_id);
             table_id_page_id_map[i.first] = root_page_id;
@@ -1380,6 +1675,223 @@ void GDBE::deleteRecursiveAux(const std::unordered_map<std::string, std::pair<In
         delete[] id_ptr;
     }
 }
+bool GDBE::isRangeDelete(const std::string &table_name, const std::unordered_map<std::unordered_set<std::string>, std::vector<Node>, MySetHashFunction> &table_condition_map, const std::unordered_map<std::string, std::pair<IndexSchema, std::pair<Token, Token>>> &table_index_condition_map)
+{
+    const TableSchema &table_schema = database_schema_.table_schema_map[table_name];
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (!i.second.be_reference_set.empty())
+            return false;
+    }
+    for (auto &&i : table_condition_map)
+    {
+        if (i.first.empty())
+        {
+            for (auto &&j : i.second)
+            {
+                if (j.token.token_type != kNum || !j.token.num)
+                    return false;
+            }
+            continue;
+        }
+        const auto &index_condition_iter = table_index_condition_map.find(table_name);
+        if (index_condition_iter == table_index_condition_map.end() || index_condition_iter->second.first.root_page_id == -1)
+            return false;
+        const std::string &column_name = index_condition_iter->second.first.column_name;
+        int data_type = table_schema.column_schema_map.at(column_name).data_type;
+        for (auto &&j : i.second)
+        {
+            if (j.token.token_type != kGreaterEqual && j.token.token_type != kLessEqual && j.token.token_type != kEqual)
+                return false;
+            const Node &name_node = j.children.front();
+            const Node &value_node = j.children.back();
+            if (name_node.token.token_type != kName || name_node.children.back().token.str != column_name)
+                return false;
+            if (value_node.token.token_type != kNum && value_node.token.token_type != kString)
+                return false;
+            if (data_type != 0 && value_node.token.str.size() >= data_type)
+                return false;
+        }
+    }
+    return true;
+}
+
+void GDBE::deleteRange(const std::string &table_name, std::pair<IndexSchema, std::pair<Token, Token>> index_condition)
+{
+    TableSchema &table_schema = database_schema_.table_schema_map[table_name];
+    if (index_condition.first.root_page_id == -1)
+    {
+        truncateTable(table_schema);
+        return;
+    }
+    std::string column_name = index_condition.first.column_name;
+    std::pair<Token, Token> condition = index_condition.second;
+    int data_type = table_schema.column_schema_map[column_name].data_type;
+    size_t size = data_type == 0 ? kSizeOfLong : data_type;
+    if (data_type == 0)
+    {
+        convertInt(condition.first);
+        convertInt(condition.second);
+    }
+    else
+    {
+        convertString(condition.first);
+        convertString(condition.second);
+    }
+    char *begin_key = nullptr, *end_key = nullptr;
+    if (condition.first)
+    {
+        begin_key = new char[size + kSizeOfBool];
+        serializeKey(condition.first, size, begin_key);
+    }
+    if (condition.second)
+    {
+        end_key = new char[size + kSizeOfBool];
+        serializeKey(condition.second, size, end_key);
+    }
+    std::vector<size_t> id_vector;
+    for (auto &&i : BPlusTreeSelect(index_condition.first.root_page_id, begin_key, end_key, true))
+        id_vector.push_back(deserializeId(i + size + kSizeOfBool));
+    std::sort(id_vector.begin(), id_vector.end(), [](size_t lhs, size_t rhs) { return static_cast<long>(lhs) < static_cast<long>(rhs); });
+    bool other_index = false;
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (i.first != column_name && (i.second.index_schema.root_page_id != -1 || table_schema.index_schema_map.find({i.first}) != table_schema.index_schema_map.end()))
+            other_index = true;
+    }
+    bool overflow = hasOverflow(table_schema);
+    std::vector<std::pair<size_t, size_t>> run_vector;
+    char *id_key = new char[kSizeOfSizeT + kSizeOfBool];
+    size_t n = 0;
+    while (n < id_vector.size())
+    {
+        size_t first = n;
+        serializeRowKey(id_vector[n], id_key);
+        Iterator iterator = BPlusTreeSelect(table_schema.root_page_id, id_key, nullptr, false);
+        for (auto iter = iterator.begin(), end_iter = iterator.end(); iter != end_iter && n < id_vector.size(); ++iter)
+        {
+            size_t id = -1;
+            if (deserializeId(*iter + kSizeOfBool) != id_vector[n])
+                break;
+            if (overflow)
+                freeRowOverflow(*iter, table_schema);
+            if (other_index)
+            {
+                id = id_vector[n];
+                auto column_map = table_schema.columnar ? columnTokenMaps(table_schema, {*iter}).front() : toTokenMap(*iter, table_schema, kSizeOfSizeT, &id);
+                for (auto &&pair : table_schema.column_schema_map)
+                {
+                    if (pair.first == column_name)
+                        continue;
+                    ColumnSchema &column_schema = pair.second;
+                    size_t column_size = column_schema.data_type ? column_schema.data_type : kSizeOfLong;
+                    char *key = new char[column_size + kSizeOfBool + kSizeOfSizeT];
+                    serializeKey(column_map[pair.first], column_size, key);
+                    serializeId(id, key + column_size + kSizeOfBool);
+                    if (column_schema.index_schema.root_page_id != -1)
+                        BPlusTreeDelete(column_schema.index_schema.root_page_id, key, &column_schema.index_schema.root_page_id);
+                    if (table_schema.index_schema_map.find({pair.first}) != table_schema.index_schema_map.end())
+                    {
+                        for (auto &&index_schema_pair : table_schema.index_schema_map[{pair.first}])
+                            BPlusTreeDelete(index_schema_pair.second.root_page_id, key, &index_schema_pair.second.root_page_id);
+                    }
+                    delete[] key;
+                }
+            }
+            ++n;
+        }
+        if (n == first)
+            ++n;
+        else
+            run_vector.push_back({id_vector[first], id_vector[n - 1]});
+    }
+    char *end_id_key = new char[kSizeOfSizeT + kSizeOfBool];
+    for (auto &&i : run_vector)
+    {
+        serializeRowKey(i.first, id_key);
+        serializeRowKey(i.second, end_id_key);
+        BPlusTreeDeleteRange(table_schema.root_page_id, id_key, end_id_key, false, &table_schema.root_page_id);
+        for (auto &&j : table_schema.column_schema_map)
+        {
+            if (table_schema.columnar)
+                BPlusTreeDeleteRange(j.second.column_root_page_id, id_key, end_id_key, false, &j.second.column_root_page_id);
+        }
+        if (table_schema.zone_root_page_id == -1)
+            continue;
+        for (std::vector<char> zone = findZone(table_schema, id_key); !zone.empty() && std::memcmp(zone.data() + kSizeOfBool + kSizeOfSizeT, end_id_key, kSizeOfBool + kSizeOfSizeT) <= 0;)
+        {
+            std::vector<char> zone_end_key(zone.begin(), zone.begin() + kSizeOfBool + kSizeOfSizeT);
+            refreshZone(table_schema, zone);
+            zone = findZone(table_schema, zone_end_key.data());
+        }
+    }
+    ColumnSchema &column_schema = table_schema.column_schema_map[column_name];
+    if (column_schema.index_schema.root_page_id != -1)
+        BPlusTreeDeleteRange(column_schema.index_schema.root_page_id, begin_key, end_key, true, &column_schema.index_schema.root_page_id);
+    if (table_schema.index_schema_map.find({column_name}) != table_schema.index_schema_map.end())
+    {
+        for (auto &&index_schema_pair : table_schema.index_schema_map[{column_name}])
+            BPlusTreeDeleteRange(index_schema_pair.second.root_page_id, begin_key, end_key, true, &index_schema_pair.second.root_page_id);
+    }
+    delete[] id_key;
+    delete[] end_id_key;
+    if (begin_key)
+        delete[] begin_key;
+    if (end_key)
+        delete[] end_key;
+}
+
+void GDBE::execTruncate(const Node &truncate_node)
+{
+    if (database_name_.empty())
+        throw Error(kNoDatabaseSelectError, "");
+    std::string table_name = getTableName(truncate_node.children.front(), database_name_);
+    auto table_iter = database_schema_.table_schema_map.find(table_name);
+    if (table_iter == database_schema_.table_schema_map.end())
+        throw Error(kTableNotExistError, table_name);
+    for (auto &&i : table_iter->second.column_schema_map)
+    {
+        if (!i.second.be_reference_set.empty())
+            throw Error(kForeignkeyConstraintError, "");
+    }
+    truncateTable(table_iter->second);
+    table_iter->second.max_id = 0;
+    updateDatabaseSchema();
+    result_.type = kTruncateResult;
+}
+
+void GDBE::truncateTable(TableSchema &table_schema)
+{
+    freeTableOverflow(table_schema);
+    table_schema.root_page_id = BPlusTreeTruncate(table_schema.root_page_id);
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (i.second.column_root_page_id != -1)
+            i.second.column_root_page_id = BPlusTreeTruncate(i.second.column_root_page_id);
+        if (i.second.index_schema.root_page_id != -1)
+            i.second.index_schema.root_page_id = BPlusTreeTruncate(i.second.index_schema.root_page_id);
+    }
+    if (table_schema.zone_root_page_id != -1)
+    {
+        table_schema.zone_root_page_id = BPlusTreeTruncate(table_schema.zone_root_page_id);
+        initZoneTree(table_schema);
+    }
+    for (auto &&i : table_schema.index_schema_map)
+    {
+        for (auto &&j : i.second)
+            j.second.root_page_id = BPlusTreeTruncate(j.second.root_page_id);
+    }
+}
+
+// Frees the overflow chains of every row before the rows themselves go.
+void GDBE::freeTableOverflow(const TableSchema &table_schema)
+{
+    if (!hasOverflow(table_schema))
+        return;
+    for (auto &&iter : BPlusTreeSelect(table_schema.root_page_id, nullptr, nullptr, false))
+        freeRowOverflow(iter, table_schema);
+}
+
 void GDBE::execCreateIndex(const Node &index_node)
 {
     if (database_name_.empty())
@@ -1402,7 +1914,9 @@ void GDBE::execCreateIndex(const Node &index_node)
     int data_type = column_schema.data_type;
     size_t index_size = data_type == 0 ? kSizeOfLong + kSizeOfBool : data_type + kSizeOfBool;
     size_t key_size = index_size + kSizeOfSizeT;
-    PageSchema index_page_schema(true, 0, -1, -1, key_size, index_size, kSizeOfSizeT, !data_type);
+    if (dataOverFlow(key_size, kSizeOfSizeT))
+        throw Error(kDataOverFlowError, "");
+    PageSchema index_page_schema(true, 0, -1, -1, key_size, index_size, kSizeOfSizeT);
     IndexSchema index_schema;
     index_schema.column_name = column_name;
     index_schema.root_page_id = createNewPage(index_page_schema);
@@ -1411,16 +1925,21 @@ void GDBE::execCreateIndex(const Node &index_node)
     auto &&begin_iter = iterator.begin();
     auto &&end_iter = iterator.end();
     size_t root_page_id = -1;
+    std::unique_ptr<ColumnCursor> column_cursor;
+    std::unordered_set<std::string> column_set{column_name};
+    if (table_schema.columnar)
+        column_cursor.reset(new ColumnCursor(table_schema, &column_set, nullptr, nullptr));
     for (auto &&iter = begin_iter; iter != end_iter; ++iter)
     {
-        size_t id = -1;
-        std::unordered_map<std::string, Token> column_token_map = toTokenMap(*iter, table_schema, kSizeOfSizeT, &id);
+        size_t id = column_cursor ? deserializeId(*iter + kSizeOfBool) : -1;
+        std::unordered_map<std::string, Token> column_token_map = column_cursor ? column_cursor->next() : toTokenMap(*iter, table_schema, kSizeOfSizeT, &id);
         Token index_token = column_token_map[column_name];
         char *key_ptr = new char[key_size];
         char *values_ptr = new char[kSizeOfSizeT];
-        serilization({index_token}, {index_size - kSizeOfBool}, key_ptr);
-        std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, key_ptr + index_size);
-        std::copy(reinterpret_cast<const char *>(&id), reinterpret_cast<const char *>(&id) + kSizeOfSizeT, values_ptr);
+        serializeKey(index_token, index_size - kSizeOfBool, key_ptr);
+        serializeId(id, key_ptr + index_size);
+        size_t row_page_id = iter.getPageId();
+        std::copy(reinterpret_cast<const char *>(&row_page_id), reinterpret_cast<const char *>(&row_page_id) + kSizeOfSizeT, values_ptr);
         BPlusTreeInsert(index_schema.root_page_id, key_ptr, values_ptr, false, &root_page_id);
         if (root_page_id != -1)
         {
@@ -1436,6 +1955,94 @@ void GDBE::execCreateIndex(const Node &index_node)
     result_.type = kCreateIndexResult;
 }
 
+void GDBE::execSet(const Node &set_node)
+{
+    const Node &variable_node = set_node.children.front();
+    const Node &value_node = variable_node.children.front();
+    if (value_node.token.num <= 0)
+        throw Error(kIncorrectValueError, value_node.token.str);
+    buffer_pool_.resize(value_node.token.num);
+    result_.type = kSetResult;
+}
+
+void GDBE::execShowBufferPool(const Node &buffer_node)
+{
+    std::vector<std::vector<std::string>> &rows = result_.string_vector_vector;
+    rows.push_back({"capacity", std::to_string(buffer_pool_.capacity())});
+    rows.push_back({"resident", std::to_string(buffer_pool_.size())});
+    rows.push_back({"pinned", std::to_string(buffer_pool_.pinnedCount())});
+    rows.push_back({"hits", std::to_string(buffer_pool_.hitCount())});
+    rows.push_back({"misses", std::to_string(buffer_pool_.missCount())});
+    rows.push_back({"evictions", std::to_string(buffer_pool_.evictionCount())});
+    rows.push_back({"read ahead", std::to_string(buffer_pool_.readAheadCount())});
+    rows.push_back({"page reads", std::to_string(file_system_.readCount())});
+    rows.push_back({"page writes", std::to_string(file_system_.writeCount())});
+    rows.push_back({"compressed writes", std::to_string(file_system_.compressedWriteCount())});
+    if (!database_name_.empty())
+    {
+        size_t schema_count = 0;
+        for (auto &&i : database_schema_.page_vector)
+            schema_count += buffer_pool_.peekPage(i) != nullptr;
+        rows.push_back({database_name_, std::to_string(schema_count)});
+        for (auto &&i : database_schema_.table_schema_map)
+        {
+            const TableSchema &table_schema = i.second;
+            rows.push_back({i.first, std::to_string(BPlusTreeResidentCount(table_schema.root_page_id))});
+            for (auto &&j : table_schema.column_schema_map)
+            {
+                if (j.second.index_schema.root_page_id != -1)
+                    rows.push_back({i.first + "." + j.first, std::to_string(BPlusTreeResidentCount(j.second.index_schema.root_page_id))});
+            }
+            for (auto &&j : table_schema.index_schema_map)
+            {
+                for (auto &&k : j.second)
+                    rows.push_back({i.first + "." + k.first, std::to_string(BPlusTreeResidentCount(k.second.root_page_id))});
+            }
+        }
+    }
+    result_.type = kShowBufferPoolResult;
+}
+
+void GDBE::dumpWarmup()
+{
+    if (database_name_.empty())
+        return;
+    std::vector<size_t> page_id_vector = buffer_pool_.getResidentPages(file_system_.getFileId());
+    if (!file_system_.exists(kWarmupDir))
+        file_system_.create_directory(kWarmupDir);
+    std::fstream file(kWarmupDir + database_name_, std::fstream::out | std::fstream::binary | std::fstream::trunc);
+    size_t size = page_id_vector.size();
+    file.write(reinterpret_cast<const char *>(&size), kSizeOfSizeT);
+    file.write(reinterpret_cast<const char *>(page_id_vector.data()), size * kSizeOfSizeT);
+}
+
+// A dump whose count does not match its length or that names a page past the
+// end of the database is damaged or stale, and is ignored. A dump taken with
+// a larger buffer pool is still used: its pages come hottest first, so only
+// the first capacity() of them are loaded.
+void GDBE::loadWarmup()
+{
+    std::fstream file(kWarmupDir + database_name_, std::fstream::in | std::fstream::binary | std::fstream::ate);
+    size_t length = file.tellg();
+    size_t size = 0;
+    if (!file.seekg(0) || !file.read(reinterpret_cast<char *>(&size), kSizeOfSizeT))
+        return;
+    if (size >= length / kSizeOfSizeT || length != (size + 1) * kSizeOfSizeT)
+        return;
+    std::vector<size_t> page_id_vector(size);
+    if (!file.read(reinterpret_cast<char *>(page_id_vector.data()), size * kSizeOfSizeT))
+        return;
+    size_t page_count = file_system_.size() / database_schema_.page_size;
+    for (auto &&page_id : page_id_vector)
+    {
+        if (page_id >= page_count)
+            return;
+    }
+    if (page_id_vector.size() > buffer_pool_.capacity())
+        page_id_vector.resize(buffer_pool_.capacity());
+    buffer_pool_.prefetch(std::move(page_id_vector));
+}
+
 void GDBE::execShowIndex(const Node &index_node)
 {
     if (database_name_.empty())
@@ -1505,27 +2112,187 @@ size_t GDBE::getExprDataType(const Node &node)
     }
 }
 
+void GDBE::insertColumns(TableSchema &table_schema, char *key, const std::vector<Token> &values)
+{
+    std::vector<char> column_value;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        ColumnSchema &column_schema = table_schema.column_schema_map[table_schema.column_order_vector[i]];
+        column_value.resize(columnValueSize(column_schema));
+        serializeColumnValue(values[i], column_schema, column_value.data());
+        BPlusTreeInsert(column_schema.column_root_page_id, key, column_value.data(), false, &column_schema.column_root_page_id);
+    }
+}
+
+void GDBE::deleteColumns(TableSchema &table_schema, char *key)
+{
+    for (auto &&i : table_schema.column_schema_map)
+        BPlusTreeDelete(i.second.column_root_page_id, key, &i.second.column_root_page_id);
+}
+
+// A zone takes about as many rows as a leaf of the table holds.
+size_t GDBE::zoneCapacity(const TableSchema &table_schema)
+{
+    size_t value_size = getValueSize(table_schema.column_schema_map);
+    if (table_schema.columnar)
+    {
+        value_size = 0;
+        for (auto &&i : table_schema.column_schema_map)
+            value_size = std::max(value_size, columnValueSize(i.second));
+    }
+    return std::max<size_t>((database_schema_.page_size - kOffsetOfPageHeader) / (kSizeOfBool + kSizeOfSizeT + value_size), 1);
+}
+
+// Gives an empty zone tree the one zone that spans every key.
+void GDBE::initZoneTree(TableSchema &table_schema)
+{
+    std::vector<char> begin_key(kSizeOfBool + kSizeOfSizeT, 0);
+    std::vector<char> zone(kSizeOfBool + kSizeOfSizeT, static_cast<char>(0xff));
+    zone.resize(zone.size() + zoneValueSize(table_schema));
+    emptyZone(table_schema, begin_key.data(), zone.data() + kSizeOfBool + kSizeOfSizeT);
+    BPlusTreeInsert(table_schema.zone_root_page_id, zone.data(), zone.data() + kSizeOfBool + kSizeOfSizeT, true, &table_schema.zone_root_page_id);
+}
+
+// Widens the zone of a new row. A full zone is split at the row instead,
+// which for rows added in key order starts a new zone, and both halves are
+// summed up from their rows.
+void GDBE::insertZone(TableSchema &table_schema, char *key, const std::vector<Token> &values)
+{
+    if (table_schema.zone_root_page_id == -1)
+        return;
+    size_t key_size = kSizeOfBool + kSizeOfSizeT;
+    std::vector<char> zone = findZone(table_schema, key);
+    char *zone_value = zone.data() + key_size;
+    if (*reinterpret_cast<const size_t *>(zone_value + kOffsetOfZoneCount) < zoneCapacity(table_schema) || std::memcmp(key, zone_value, key_size) == 0)
+    {
+        std::unordered_map<std::string, Token> column_token_map;
+        for (size_t i = 0; i < values.size(); ++i)
+            column_token_map[table_schema.column_order_vector[i]] = values[i];
+        widenZone(table_schema, column_token_map, zone_value);
+        BPlusTreeUpdate(table_schema.zone_root_page_id, zone.data(), zone_value);
+        return;
+    }
+    std::vector<char> lower_zone(zone);
+    std::copy(key, key + key_size, lower_zone.data());
+    summarizeZone(table_schema, key, lower_zone.data() + key_size);
+    std::copy(key, key + key_size, zone_value);
+    summarizeZone(table_schema, zone.data(), zone_value);
+    BPlusTreeUpdate(table_schema.zone_root_page_id, zone.data(), zone_value);
+    BPlusTreeInsert(table_schema.zone_root_page_id, lower_zone.data(), lower_zone.data() + key_size, true, &table_schema.zone_root_page_id);
+}
+
+// A delete only counts the row out of its zone, whose range stays wide
+// enough for the rows left. A zone counted down to none is summed up again.
+void GDBE::deleteZone(TableSchema &table_schema, char *key)
+{
+    if (table_schema.zone_root_page_id == -1)
+        return;
+    std::vector<char> zone = findZone(table_schema, key);
+    char *zone_value = zone.data() + kSizeOfBool + kSizeOfSizeT;
+    size_t &count = *reinterpret_cast<size_t *>(zone_value + kOffsetOfZoneCount);
+    if (count > 1)
+    {
+        --count;
+        BPlusTreeUpdate(table_schema.zone_root_page_id, zone.data(), zone_value);
+    }
+    else
+        refreshZone(table_schema, zone);
+}
+
+// Sums a zone up from its rows. A zone left without rows is folded into the
+// one after it, unless it is the last.
+void GDBE::refreshZone(TableSchema &table_schema, std::vector<char> &zone)
+{
+    size_t key_size = kSizeOfBool + kSizeOfSizeT;
+    char *zone_value = zone.data() + key_size;
+    summarizeZone(table_schema, zone.data(), zone_value);
+    std::vector<char> next_zone = findZone(table_schema, zone.data());
+    if (*reinterpret_cast<const size_t *>(zone_value + kOffsetOfZoneCount) != 0 || next_zone.empty())
+    {
+        BPlusTreeUpdate(table_schema.zone_root_page_id, zone.data(), zone_value);
+        return;
+    }
+    std::copy(zone_value, zone_value + key_size, next_zone.data() + key_size);
+    BPlusTreeUpdate(table_schema.zone_root_page_id, next_zone.data(), next_zone.data() + key_size);
+    BPlusTreeDelete(table_schema.zone_root_page_id, zone.data(), &table_schema.zone_root_page_id);
+}
+
+// Pages of a COMPRESSED table are compressed by the file system as they are
+// written; it knows them by the tree id in their header.
+void GDBE::setCompressedTrees()
+{
+    std::unordered_set<size_t> tree_id_set;
+    for (auto &&i : database_schema_.table_schema_map)
+    {
+        if (!i.second.compressed)
+            continue;
+        tree_id_set.insert(i.second.tree_id);
+        for (auto &&j : i.second.column_schema_map)
+        {
+            if (i.second.columnar)
+                tree_id_set.insert(j.second.column_tree_id);
+        }
+    }
+    file_system_.setCompressedTrees(tree_id_set);
+}
+
 size_t GDBE::getValueSize(const std::unordered_map<std::string, ColumnSchema> &column_schema_map)
 {
     size_t size = 0;
-    size += (column_schema_map.size()) * kSizeOfBool;
+    size_t threshold = overflowThreshold(column_schema_map);
+    size += (column_schema_map.size() + 7) / 8;
     for (auto &&i : column_schema_map)
     {
         if (i.second.data_type == 0)
             size += kSizeOfLong;
         else
-            size += i.second.data_type;
+            size += i.second.varchar ? kSizeOfVarcharLength + std::min(static_cast<size_t>(i.second.data_type), threshold) : i.second.dictionary ? kSizeOfDictionaryCode : i.second.data_type;
     }
     return size;
 }
 
+// On a CLUSTERED table the row id is the primary key value, and an INT key
+// encodes to the same bytes as a table key, so a range on the primary key
+// bounds a scan of the table tree itself.
+bool GDBE::clusteredRange(const TableSchema &table_schema, const std::pair<IndexSchema, std::pair<Token, Token>> &index_condition, char **begin_key_ptr, char **end_key_ptr)
+{
+    if (!table_schema.clustered || table_schema.primary_set.find(index_condition.first.column_name) == table_schema.primary_set.end())
+        return false;
+    std::pair<Token, Token> condition = index_condition.second;
+    convertInt(condition.first);
+    convertInt(condition.second);
+    if (condition.first)
+    {
+        *begin_key_ptr = new char[kSizeOfLong + kSizeOfBool];
+        serializeKey(condition.first, kSizeOfLong, *begin_key_ptr);
+    }
+    if (condition.second)
+    {
+        *end_key_ptr = new char[kSizeOfLong + kSizeOfBool];
+        serializeKey(condition.second, kSizeOfLong, *end_key_ptr);
+    }
+    return true;
+}
+
+bool GDBE::nextKeyBatch(Iter &iter, Iter &end, size_t key_size, std::vector<char> &key_buffer, std::vector<char *> &key_vector)
+{
+    size_t batch_size = std::max(kReadAheadSize, buffer_pool_.capacity() / 8);
+    key_buffer.clear();
+    key_vector.clear();
+    for (; iter != end && key_buffer.size() < batch_size * key_size; ++iter)
+        key_buffer.insert(key_buffer.end(), *iter, *iter + key_size);
+    for (size_t pos = 0; pos < key_buffer.size(); pos += key_size)
+        key_vector.push_back(key_buffer.data() + pos);
+    return !key_vector.empty();
+}
+
 void GDBE::updateDatabaseSchema()
 {
-    size_t page_num = (getSize(database_schema_) - 1) / kPageSize + 1;
+    size_t page_num = (getSize(database_schema_) - 1) / database_schema_.page_size + 1;
     while (page_num > database_schema_.page_vector.size())
     {
         database_schema_.page_vector.push_back(getFreePage());
-        page_num = (getSize(database_schema_) - 1) / kPageSize + 1;
+        page_num = (getSize(database_schema_) - 1) / database_schema_.page_size + 1;
     }
     std::vector<PagePtr> page_ptr_vector;
     for (auto &&i : database_schema_.page_vector)
@@ -1566,7 +2333,7 @@ std::pair<IndexSchema, std::pair<Token, Token>> GDBE::getCondition(std::vector<N
                 convertInt(i.children.back().token);
             else if (data_type > 0)
                 convertString(i.children.back().token);
-            if ((i.token.token_type == kGreater || i.token.token_type == kGreaterEqual))
+            if (i.token.token_type == kGreater || i.token.token_type == kGreaterEqual || i.token.token_type == kEqual)
             {
                 if (condition.first.token_type == kNone)
                     condition.first = i.children.back().token;
@@ -1575,19 +2342,15 @@ std::pair<IndexSchema, std::pair<Token, Token>> GDBE::getCondition(std::vector<N
                 else if (data_type > 0 && i.children.back().token.str > condition.first.str)
                     condition.first = i.children.back().token;
             }
-            else if ((i.token.token_type == kLess || i.token.token_type == kLessEqual))
+            if (i.token.token_type == kLess || i.token.token_type == kLessEqual || i.token.token_type == kEqual)
             {
                 if (condition.second.token_type == kNone)
                     condition.second = i.children.back().token;
-                else if (data_type == 0 && i.children.back().token.num < condition.first.num)
+                else if (data_type == 0 && i.children.back().token.num < condition.second.num)
                     condition.second = i.children.back().token;
-                else if (data_type > 0 && i.children.back().token.str < condition.first.str)
+                else if (data_type > 0 && i.children.back().token.str < condition.second.str)
                     condition.second = i.children.back().token;
             }
-            else if (i.token.token_type == kEqual)
-            {
-                condition.first = condition.second = i.children.back().token;
-            }
             if (condition.first.token_type == kNum && condition.second.token_type == kNum && condition.first.num > condition.second.num)
                 *rc = false;
             if (condition.first.token_type == kString && condition.second.token_type == kString && condition.first.str > condition.second.str)
@@ -1617,6 +2380,14 @@ bool GDBE::isIndexCondition(Node &node)
     else if (right_node.token.token_type == kName && (left_node.token.token_type == kNull || left_node.token.token_type == kNum || left_node.token.token_type == kString))
     {
         std::swap(right_node, left_node);
+        if (node.token.token_type == kGreater)
+            node.token.token_type = kLess;
+        else if (node.token.token_type == kGreaterEqual)
+            node.token.token_type = kLessEqual;
+        else if (node.token.token_type == kLess)
+            node.token.token_type = kGreater;
+        else if (node.token.token_type == kLessEqual)
+            node.token.token_type = kGreaterEqual;
         if (database_schema_.table_schema_map[left_node.children.front().token.str].column_schema_map[left_node.children.back().token.str].index_schema.root_page_id != -1 || database_schema_.table_schema_map[left_node.children.front().token.str].index_schema_map.find({left_node.children.back().token.str}) != database_schema_.table_schema_map[left_node.children.front().token.str].index_schema_map.end())
             return true;
         else
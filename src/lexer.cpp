@@ -72,6 +72,8 @@ std::queue<Token> Lexer::lex(const std::string &input)
                 token_queue.push(Token(kReferences, str));
             else if (temp_str == "CHAR")
                 token_queue.push(Token(kChar, str));
+            else if (temp_str == "VARCHAR")
+                token_queue.push(Token(kVarchar, str));
             else if (temp_str == "INT")
                 token_queue.push(Token(kInt, str));
             else if (temp_str == "DATABASES")
@@ -100,6 +102,30 @@ std::queue<Token> Lexer::lex(const std::string &input)
                 token_queue.push(Token(kUnique, str));
             else if (temp_str == "EXIT")
                 token_queue.push(Token(kExit, str));
+            else if (temp_str == "TRUNCATE")
+                token_queue.push(Token(kTruncate, str));
+            else if (temp_str == "BETWEEN")
+                token_queue.push(Token(kBetween, str));
+            else if (temp_str == "BUFFER")
+                token_queue.push(Token(kBuffer, str));
+            else if (temp_str == "POOL")
+                token_queue.push(Token(kPool, str));
+            else if (temp_str == "BUFFER_POOL_SIZE")
+                token_queue.push(Token(kBufferPoolSize, str));
+            else if (temp_str == "PAGE_SIZE")
+                token_queue.push(Token(kPageSize, str));
+            else if (temp_str == "CLUSTERED")
+                token_queue.push(Token(kClustered, str));
+            else if (temp_str == "DICTIONARY")
+                token_queue.push(Token(kDictionary, str));
+            else if (temp_str == "COMPRESSED")
+                token_queue.push(Token(kCompressed, str));
+            else if (temp_str == "ENGINE")
+                token_queue.push(Token(kEngine, str));
+            else if (temp_str == "COLUMNAR")
+                token_queue.push(Token(kColumnar, str));
+            else if (temp_str == "ZONEMAP")
+                token_queue.push(Token(kZoneMap, str));
             else
                 token_queue.push(Token(kStr, str));
         }
@@ -4,8 +4,19 @@
 #include "error.h"
 #include "gdbe.h"
 
-int main()
+int main(int argc, char *argv[])
 {
+    const std::string buffer_pool_size_option = "--buffer-pool-size=";
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, buffer_pool_size_option.size(), buffer_pool_size_option) == 0)
+            BufferPool::getInstance().resize(std::stoul(arg.substr(buffer_pool_size_option.size())));
+        else if (arg == "--mmap")
+            FileSystem::getInstance().setMmap(true);
+        else if (arg == "--direct-io")
+            FileSystem::getInstance().setDirectIo(true);
+    }
     std::string str;
     std::queue<Token> token_queue;
     SyntaxTree syntax_tree;
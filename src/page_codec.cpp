@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "page_codec.h"
+
+constexpr size_t kHashBits = 12;
+constexpr size_t kMaxNibble = 15;
+constexpr size_t kMaxLengthByte = 255;
+
+uint32_t loadQuad(const char *pos)
+{
+    uint32_t quad;
+    std::memcpy(&quad, pos, sizeof(quad));
+    return quad;
+}
+
+size_t hashQuad(uint32_t quad)
+{
+    return (quad * 2654435761U) >> (32 - kHashBits);
+}
+
+bool putLength(size_t length, unsigned char *&out, const unsigned char *end)
+{
+    for (; length >= kMaxLengthByte; length -= kMaxLengthByte)
+    {
+        if (out == end)
+            return false;
+        *out++ = kMaxLengthByte;
+    }
+    if (out == end)
+        return false;
+    *out++ = length;
+    return true;
+}
+
+bool getLength(const unsigned char *&in, const unsigned char *end, size_t *length)
+{
+    unsigned char byte;
+    do
+    {
+        if (in == end)
+            return false;
+        byte = *in++;
+        *length += byte;
+    } while (byte == kMaxLengthByte);
+    return true;
+}
+
+// A match_size of 0 ends the block after the literals.
+bool putSequence(const char *literal, size_t literal_size, size_t offset, size_t match_size, unsigned char *&out, const unsigned char *end)
+{
+    if (out == end)
+        return false;
+    size_t match_code = match_size ? match_size - kMinMatchSize : 0;
+    unsigned char *token = out++;
+    *token = std::min(literal_size, kMaxNibble) << 4 | std::min(match_code, kMaxNibble);
+    if (literal_size >= kMaxNibble && !putLength(literal_size - kMaxNibble, out, end))
+        return false;
+    if (static_cast<size_t>(end - out) < literal_size)
+        return false;
+    std::memcpy(out, literal, literal_size);
+    out += literal_size;
+    if (match_size == 0)
+        return true;
+    if (end - out < 2)
+        return false;
+    *out++ = offset & 0xff;
+    *out++ = offset >> 8;
+    return match_code < kMaxNibble || putLength(match_code - kMaxNibble, out, end);
+}
+
+size_t compressBlock(const char *src, size_t size, char *dst, size_t capacity)
+{
+    std::vector<size_t> hash_table(1 << kHashBits, -1);
+    unsigned char *out = reinterpret_cast<unsigned char *>(dst);
+    const unsigned char *end = out + capacity;
+    size_t anchor = 0, pos = 0;
+    while (pos + kMinMatchSize <= size)
+    {
+        uint32_t quad = loadQuad(src + pos);
+        size_t &slot = hash_table[hashQuad(quad)];
+        size_t candidate = slot;
+        slot = pos;
+        if (candidate == -1 || pos - candidate > kMaxMatchOffset || loadQuad(src + candidate) != quad)
+        {
+            ++pos;
+            continue;
+        }
+        size_t match_size = kMinMatchSize;
+        while (pos + match_size < size && src[candidate + match_size] == src[pos + match_size])
+            ++match_size;
+        if (!putSequence(src + anchor, pos - anchor, pos - candidate, match_size, out, end))
+            return 0;
+        pos += match_size;
+        anchor = pos;
+    }
+    if (!putSequence(src + anchor, size - anchor, 0, 0, out, end))
+        return 0;
+    return out - reinterpret_cast<unsigned char *>(dst);
+}
+
+bool decompressBlock(const char *src, size_t src_size, char *dst, size_t size)
+{
+    const unsigned char *in = reinterpret_cast<const unsigned char *>(src);
+    const unsigned char *end = in + src_size;
+    size_t pos = 0;
+    while (in < end)
+    {
+        unsigned char token = *in++;
+        size_t literal_size = token >> 4;
+        if (literal_size == kMaxNibble && !getLength(in, end, &literal_size))
+            return false;
+        if (literal_size > static_cast<size_t>(end - in) || literal_size > size - pos)
+            return false;
+        std::memcpy(dst + pos, in, literal_size);
+        in += literal_size;
+        pos += literal_size;
+        if (in == end)
+            break;
+        if (end - in < 2)
+            return false;
+        size_t offset = in[0] | in[1] << 8;
+        in += 2;
+        size_t match_size = token & kMaxNibble;
+        if (match_size == kMaxNibble && !getLength(in, end, &match_size))
+            return false;
+        match_size += kMinMatchSize;
+        if (offset == 0 || offset > pos || match_size > size - pos)
+            return false;
+        // A match may overlap the bytes it produces, so it is copied a byte
+        // at a time.
+        for (size_t i = 0; i < match_size; ++i, ++pos)
+            dst[pos] = dst[pos - offset];
+    }
+    return pos == size;
+}
+
+// FNV-1a.
+uint32_t blockChecksum(const char *data, size_t size)
+{
+    uint32_t checksum = 2166136261U;
+    for (size_t i = 0; i < size; ++i)
+    {
+        checksum ^= static_cast<unsigned char>(data[i]);
+        checksum *= 16777619U;
+    }
+    return checksum;
+}
@@ -51,6 +51,12 @@ Node Parser::parseAll()
     case kExplain:
         temp_node = parseExplain();
         break;
+    case kTruncate:
+        temp_node = parseTruncate();
+        break;
+    case kSet:
+        temp_node = parseSet();
+        break;
     case kExit:
         temp_node = Node(next());
         break;
@@ -77,6 +83,10 @@ Node Parser::parseShow()
         build(parseName(2), index_node_ptr);
         return show_node;
     }
+    case kBuffer:
+        build(next(), &show_node);
+        match(kPool);
+        return show_node;
     default:
         throw Error(kSqlError, lookAhead().str);
     }
@@ -99,6 +109,12 @@ Node Parser::parseCreate()
     {
         Node *database_node_ptr = build(next(), &creat_node);
         build(match(kStr), database_node_ptr);
+        if (lookAhead().token_type == kPageSize)
+        {
+            Node *page_size_node_ptr = build(next(), database_node_ptr);
+            match(kEqual);
+            build(match(kNum), page_size_node_ptr);
+        }
         return creat_node;
     }
     case kTable:
@@ -109,6 +125,19 @@ Node Parser::parseCreate()
         Node columns_node = parseColumns();
         build(columns_node, table_node_ptr);
         match(kRightParenthesis);
+        while (true)
+        {
+            if (lookAhead().token_type == kClustered || lookAhead().token_type == kCompressed)
+                build(next(), table_node_ptr);
+            else if (lookAhead().token_type == kEngine)
+            {
+                Node *engine_node_ptr = build(next(), table_node_ptr);
+                match(kEqual);
+                build(match(kColumnar), engine_node_ptr);
+            }
+            else
+                break;
+        }
         return creat_node;
     }
     case kIndex:
@@ -329,6 +358,7 @@ Node Parser::parseColumn()
         build(next(), &column_node);
         break;
     case kChar:
+    case kVarchar:
     {
         Node *char_node_ptr = build(next(), &column_node);
         if (lookAhead().token_type == kLeftParenthesis)
@@ -343,7 +373,7 @@ Node Parser::parseColumn()
         throw Error(kSqlError, lookAhead().str);
     }
     TokenType token_type;
-    while ((token_type = lookAhead().token_type) == kNot || token_type == kDefault || token_type == kUnique)
+    while ((token_type = lookAhead().token_type) == kNot || token_type == kDefault || token_type == kUnique || token_type == kDictionary || token_type == kZoneMap)
     {
         switch (token_type)
         {
@@ -369,6 +399,8 @@ Node Parser::parseColumn()
             break;
         }
         case kUnique:
+        case kDictionary:
+        case kZoneMap:
         {
             build(next(), &column_node);
             break;
@@ -577,6 +609,24 @@ Node Parser::parseCompare()
         compare_node = std::move(new_compare_node);
         compare_node.token.str = str;
     }
+    if (lookAhead().token_type == kBetween)
+    {
+        std::string str = compare_node.token.str;
+        str += next().str;
+        Node low_node = parseShift();
+        str += low_node.token.str;
+        str += match(kAnd).str;
+        Node high_node = parseShift();
+        str += high_node.token.str;
+        Node between_node{Token(kAnd, str)};
+        Node *greater_equal_node_ptr = build(Token(kGreaterEqual, ">="), &between_node);
+        build(compare_node, greater_equal_node_ptr);
+        build(low_node, greater_equal_node_ptr);
+        Node *less_equal_node_ptr = build(Token(kLessEqual, "<="), &between_node);
+        build(compare_node, less_equal_node_ptr);
+        build(high_node, less_equal_node_ptr);
+        compare_node = std::move(between_node);
+    }
     return compare_node;
 }
 
@@ -723,4 +773,22 @@ Node Parser::parseExplain()
     Node explain_node{match(kExplain)};
     build(parseName(2), &explain_node);
     return explain_node;
+}
+
+Node Parser::parseTruncate()
+{
+    Node truncate_node{match(kTruncate)};
+    if (lookAhead().token_type == kTable)
+        next();
+    build(parseName(2), &truncate_node);
+    return truncate_node;
+}
+
+Node Parser::parseSet()
+{
+    Node set_node{match(kSet)};
+    Node *variable_node_ptr = build(match(kBufferPoolSize), &set_node);
+    match(kEqual);
+    build(match(kNum), variable_node_ptr);
+    return set_node;
 }
\ No newline at end of file
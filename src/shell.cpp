@@ -194,6 +194,25 @@ void Shell::showResult(const Result &result)
     case kDropIndexResult:
         std::cout << "drop index" << std::endl;
         break;
+    case kTruncateResult:
+        std::cout << "truncate table" << std::endl;
+        break;
+    case kSetResult:
+        std::cout << "set" << std::endl;
+        break;
+    case kShowBufferPoolResult:
+    {
+        int width = 24;
+        for (auto &&i : result.string_vector_vector)
+        {
+            for (auto &&j : i)
+            {
+                std::cout << std::left << std::setw(width) << std::setfill(' ') << j;
+            }
+            std::cout << std::endl;
+        }
+        break;
+    }
     case kInsertResult:
     case kDeleteResult:
         break;
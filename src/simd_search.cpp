@@ -0,0 +1,99 @@
+#include <cstring>
+#include "simd_search.h"
+#if defined(__x86_64__) && defined(__GNUC__)
+#define GSQL_SIMD_SEARCH
+#include <immintrin.h>
+#endif
+
+namespace
+{
+using CountFunction = size_t (*)(const char *, size_t, size_t, uint64_t, bool);
+
+constexpr uint64_t kSignBit = 1ULL << 63;
+
+uint64_t loadWord(const char *pos)
+{
+    uint64_t word;
+    std::memcpy(&word, pos, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+}
+
+size_t countScalar(const char *base, size_t step, size_t count, uint64_t key, bool inclusive)
+{
+    size_t result = 0;
+    for (; result < count; ++result)
+    {
+        uint64_t word = loadWord(base + result * step);
+        if (inclusive ? word > key : word >= key)
+            break;
+    }
+    return result;
+}
+
+#ifdef GSQL_SIMD_SEARCH
+// The words are unsigned but both instruction sets only compare signed
+// 64-bit lanes, so the sign bit of each side is flipped first.
+__attribute__((target("sse4.2"))) size_t countSse42(const char *base, size_t step, size_t count, uint64_t key, bool inclusive)
+{
+    const __m128i swap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i sign = _mm_set1_epi64x(static_cast<long long>(kSignBit));
+    const __m128i key_vector = _mm_set1_epi64x(static_cast<long long>(key ^ kSignBit));
+    size_t result = 0;
+    for (; result + 2 <= count; result += 2)
+    {
+        __m128i words = _mm_set_epi64x(0, 0);
+        std::memcpy(&words, base + result * step, sizeof(uint64_t));
+        std::memcpy(reinterpret_cast<char *>(&words) + sizeof(uint64_t), base + (result + 1) * step, sizeof(uint64_t));
+        words = _mm_xor_si128(_mm_shuffle_epi8(words, swap), sign);
+        __m128i below = inclusive ? _mm_xor_si128(_mm_cmpgt_epi64(words, key_vector), _mm_set1_epi64x(-1))
+                                  : _mm_cmpgt_epi64(key_vector, words);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(below));
+        if (mask != 3)
+            return result + __builtin_popcount(mask);
+    }
+    return result + countScalar(base + result * step, step, count - result, key, inclusive);
+}
+
+__attribute__((target("avx2"))) size_t countAvx2(const char *base, size_t step, size_t count, uint64_t key, bool inclusive)
+{
+    const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                          7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i sign = _mm256_set1_epi64x(static_cast<long long>(kSignBit));
+    const __m256i key_vector = _mm256_set1_epi64x(static_cast<long long>(key ^ kSignBit));
+    const __m256i offsets = _mm256_setr_epi64x(0, step, 2 * step, 3 * step);
+    size_t result = 0;
+    for (; result + 4 <= count; result += 4)
+    {
+        __m256i words = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(base + result * step), offsets, 1);
+        words = _mm256_xor_si256(_mm256_shuffle_epi8(words, swap), sign);
+        __m256i below = inclusive ? _mm256_xor_si256(_mm256_cmpgt_epi64(words, key_vector), _mm256_set1_epi64x(-1))
+                                  : _mm256_cmpgt_epi64(key_vector, words);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(below));
+        if (mask != 15)
+            return result + __builtin_popcount(mask);
+    }
+    return result + countScalar(base + result * step, step, count - result, key, inclusive);
+}
+#endif
+
+CountFunction selectCount()
+{
+#ifdef GSQL_SIMD_SEARCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return countAvx2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return countSse42;
+#endif
+    return countScalar;
+}
+} // namespace
+
+size_t countWordsBelow(const char *base, size_t step, size_t count, uint64_t key, bool inclusive)
+{
+    static const CountFunction count_function = selectCount();
+    return count_function(base, step, count, key, inclusive);
+}
@@ -2,7 +2,8 @@
 
 Stream &operator>>(Stream &stream, DatabaseSchema &database_schema)
 {
-  stream >> database_schema.page_vector >> database_schema.settings >> database_schema.free_page_deque >> database_schema.table_schema_map >> database_schema.max_page;
+  stream >> database_schema.page_size >> database_schema.page_vector >> database_schema.settings >> database_schema.free_page_deque >> database_schema.table_schema_map >> database_schema.max_page >> database_schema.max_tree_id;
+  database_schema.free_page_set = std::unordered_set<size_t>(database_schema.free_page_deque.begin(), database_schema.free_page_deque.end());
   return stream;
 }
 
@@ -14,13 +15,13 @@ Stream &operator>>(Stream &stream, Settings &settings)
 
 Stream &operator>>(Stream &stream, TableSchema &table_schema)
 {
-  stream >> table_schema.root_page_id >> table_schema.max_id >> table_schema.column_order_vector >> table_schema.column_schema_map >> table_schema.primary_set >> table_schema.index_schema_map >> table_schema.index_column_map;
+  stream >> table_schema.root_page_id >> table_schema.max_id >> table_schema.tree_id >> table_schema.clustered >> table_schema.compressed >> table_schema.columnar >> table_schema.zone_root_page_id >> table_schema.column_order_vector >> table_schema.column_schema_map >> table_schema.primary_set >> table_schema.index_schema_map >> table_schema.index_column_map;
   return stream;
 }
 
 Stream &operator>>(Stream &stream, ColumnSchema &column_schema)
 {
-  stream >> column_schema.data_type >> column_schema.not_null >> column_schema.null_default >> column_schema.unique >> column_schema.index_schema >> column_schema.default_value >> column_schema.reference_table_name >> column_schema.reference_column_name >> column_schema.be_reference_set;
+  stream >> column_schema.data_type >> column_schema.varchar >> column_schema.dictionary >> column_schema.not_null >> column_schema.null_default >> column_schema.unique >> column_schema.index_schema >> column_schema.default_value >> column_schema.reference_table_name >> column_schema.reference_column_name >> column_schema.be_reference_set >> column_schema.dictionary_vector >> column_schema.column_root_page_id >> column_schema.column_tree_id >> column_schema.zone_map;
   return stream;
 }
 
@@ -32,7 +33,7 @@ Stream &operator>>(Stream &stream, IndexSchema &index_schema)
 
 Stream &operator<<(Stream &stream, const DatabaseSchema &database_schema)
 {
-  stream << database_schema.page_vector << database_schema.settings << database_schema.free_page_deque << database_schema.table_schema_map << database_schema.max_page;
+  stream << database_schema.page_size << database_schema.page_vector << database_schema.settings << database_schema.free_page_deque << database_schema.table_schema_map << database_schema.max_page << database_schema.max_tree_id;
   return stream;
 }
 
@@ -44,13 +45,13 @@ Stream &operator<<(Stream &stream, const Settings &settings)
 
 Stream &operator<<(Stream &stream, const TableSchema &table_schema)
 {
-  stream << table_schema.root_page_id << table_schema.max_id << table_schema.column_order_vector << table_schema.column_schema_map << table_schema.primary_set << table_schema.index_schema_map << table_schema.index_column_map;
+  stream << table_schema.root_page_id << table_schema.max_id << table_schema.tree_id << table_schema.clustered << table_schema.compressed << table_schema.columnar << table_schema.zone_root_page_id << table_schema.column_order_vector << table_schema.column_schema_map << table_schema.primary_set << table_schema.index_schema_map << table_schema.index_column_map;
   return stream;
 }
 
 Stream &operator<<(Stream &stream, const ColumnSchema &column_schema)
 {
-  stream << column_schema.data_type << column_schema.not_null << column_schema.null_default << column_schema.unique << column_schema.index_schema << column_schema.default_value << column_schema.reference_table_name << column_schema.reference_column_name << column_schema.be_reference_set;
+  stream << column_schema.data_type << column_schema.varchar << column_schema.dictionary << column_schema.not_null << column_schema.null_default << column_schema.unique << column_schema.index_schema << column_schema.default_value << column_schema.reference_table_name << column_schema.reference_column_name << column_schema.be_reference_set << column_schema.dictionary_vector << column_schema.column_root_page_id << column_schema.column_tree_id << column_schema.zone_map;
   return stream;
 }
 
@@ -87,17 +88,17 @@ size_t getSize(const std::string &data)
 
 size_t getSize(const DatabaseSchema &database_schema)
 {
-  return getSize(database_schema.page_vector) + getSize(database_schema.settings) + getSize(database_schema.free_page_deque) + getSize(database_schema.table_schema_map) + getSize(database_schema.max_page);
+  return getSize(database_schema.page_size) + getSize(database_schema.page_vector) + getSize(database_schema.settings) + getSize(database_schema.free_page_deque) + getSize(database_schema.table_schema_map) + getSize(database_schema.max_page) + getSize(database_schema.max_tree_id);
 }
 
 size_t getSize(const TableSchema &table_schema)
 {
-  return getSize(table_schema.root_page_id) + getSize(table_schema.max_id) + getSize(table_schema.column_order_vector) + getSize(table_schema.column_schema_map) + getSize(table_schema.primary_set) + getSize(table_schema.index_schema_map) + getSize(table_schema.index_column_map);
+  return getSize(table_schema.root_page_id) + getSize(table_schema.max_id) + getSize(table_schema.tree_id) + getSize(table_schema.clustered) + getSize(table_schema.compressed) + getSize(table_schema.columnar) + getSize(table_schema.zone_root_page_id) + getSize(table_schema.column_order_vector) + getSize(table_schema.column_schema_map) + getSize(table_schema.primary_set) + getSize(table_schema.index_schema_map) + getSize(table_schema.index_column_map);
 }
 
 size_t getSize(const ColumnSchema &column_schema)
 {
-  return getSize(column_schema.data_type) + getSize(column_schema.not_null) + getSize(column_schema.null_default) + getSize(column_schema.unique) + getSize(column_schema.index_schema) + getSize(column_schema.default_value) + getSize(column_schema.reference_table_name) + getSize(column_schema.reference_column_name) + getSize(column_schema.be_reference_set);
+  return getSize(column_schema.data_type) + getSize(column_schema.varchar) + getSize(column_schema.dictionary) + getSize(column_schema.not_null) + getSize(column_schema.null_default) + getSize(column_schema.unique) + getSize(column_schema.index_schema) + getSize(column_schema.default_value) + getSize(column_schema.reference_table_name) + getSize(column_schema.reference_column_name) + getSize(column_schema.be_reference_set) + getSize(column_schema.dictionary_vector) + getSize(column_schema.column_root_page_id) + getSize(column_schema.column_tree_id) + getSize(column_schema.zone_map);
 }
 
 size_t getSize(const IndexSchema &index_schema)
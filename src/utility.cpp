@@ -1,7 +1,9 @@
 #include "utility.h"
 #include <utility>
 #include <algorithm>
+#include <limits>
 #include "const.h"
+#include "b_plus_tree.h"
 
 std::string getTableName(const Node &name_node, const std::string &database_name)
 {
@@ -56,10 +58,7 @@ void serilization(const std::vector<Token> &values, const std::vector<size_t> &v
         {
             std::copy(reinterpret_cast<const char *>(&null), reinterpret_cast<const char *>(&null) + kSizeOfBool, values_ptr + pos);
             pos += kSizeOfBool;
-            if (values_size[i] == 0)
-                pos += kSizeOfLong;
-            else
-                pos += values_size[i];
+            pos += values_size[i];
         }
         else
         {
@@ -70,18 +69,340 @@ void serilization(const std::vector<Token> &values, const std::vector<size_t> &v
                 std::copy(reinterpret_cast<const char *>(&values[i].num), reinterpret_cast<const char *>(&values[i].num) + kSizeOfLong, values_ptr + pos);
                 pos += kSizeOfLong;
             }
-            else if (values[i].token_type == kString)
+            else if (values[i].token_type == kString && values[i].str.size() > values_size[i] && values_size[i] >= kSizeOfOverflowPointer)
             {
-                std::copy(values[i].str.c_str(), values[i].str.c_str() + values[i].str.size() + 1, values_ptr + pos);
-                if (values[i].str.size() + 1 < values_size[i])
+                if (values[i].overflow_page_id != -1)
                 {
-                    size_t cnt = values_size[i] - values[i].str.size() - 1;
-                    memset(values_ptr + pos + values[i].str.size() + 1, '\0', cnt);
+                    values_ptr[pos - kSizeOfBool] = kOverflowReferenceFlag;
+                    referenceOverflow(values[i].str.c_str(), values[i].str.size(), values[i].overflow_page_id, values_ptr + pos);
                 }
+                else
+                {
+                    values_ptr[pos - kSizeOfBool] = kOverflowFlag;
+                    serializeOverflow(values[i].str.c_str(), values[i].str.size(), values_ptr + pos);
+                }
+                memset(values_ptr + pos + kSizeOfOverflowPointer, '\0', values_size[i] - kSizeOfOverflowPointer);
                 pos += values_size[i];
             }
+            else if (values[i].token_type == kString)
+            {
+                size_t size = values_size[i];
+                size_t length = std::min(values[i].str.size(), size);
+                std::copy(values[i].str.c_str(), values[i].str.c_str() + length, values_ptr + pos);
+                memset(values_ptr + pos + length, '\0', size - length);
+                pos += size;
+            }
+        }
+    }
+}
+
+// The widest value a row keeps inline when its variable columns have the
+// widths in width_vector and room bytes are left for them: a quarter of the
+// page at most, lowered until the widest row fits. Longer values go to
+// overflow pages, so the limit is never below an overflow pointer.
+size_t inlineLimit(std::vector<size_t> width_vector, size_t room)
+{
+    size_t limit = FileSystem::getInstance().pageSize() / 4;
+    std::sort(width_vector.begin(), width_vector.end());
+    for (size_t i = 0; i < width_vector.size(); ++i)
+    {
+        size_t width = std::min(width_vector[i], limit);
+        if (width * (width_vector.size() - i) > room)
+        {
+            limit = room / (width_vector.size() - i);
+            break;
+        }
+        room -= width;
+    }
+    return std::max(limit, kSizeOfOverflowPointer);
+}
+
+// A VARCHAR value of a table longer than this stays in an overflow chain.
+// The rest of the row and the length of each VARCHAR are taken out of the
+// largest slotted entry dataOverFlow admits before the VARCHARs share it.
+size_t overflowThreshold(const std::unordered_map<std::string, ColumnSchema> &column_schema_map)
+{
+    size_t row_size = (FileSystem::getInstance().pageSize() - kOffsetOfPageHeader) / 3 - kSizeOfSlot - 2 * (kSizeOfSizeT + kSizeOfBool);
+    size_t fixed_size = (column_schema_map.size() + 7) / 8;
+    std::vector<size_t> width_vector;
+    for (auto &&i : column_schema_map)
+    {
+        if (i.second.varchar)
+        {
+            width_vector.push_back(i.second.data_type);
+            fixed_size += kSizeOfVarcharLength;
+        }
+        else
+            fixed_size += fixedColumnSize(i.second);
+    }
+    return inlineLimit(width_vector, row_size > fixed_size ? row_size - fixed_size : 0);
+}
+
+void serializeOverflow(const char *data, size_t size, char *value)
+{
+    referenceOverflow(data, size, writeOverflow(data + kSizeOfOverflowPrefix, size - kSizeOfOverflowPrefix), value);
+}
+
+// An overflow pointer to the chain that already holds the tail of data.
+void referenceOverflow(const char *data, size_t size, size_t page_id, char *value)
+{
+    std::copy(data, data + kSizeOfOverflowPrefix, value);
+    std::copy(reinterpret_cast<const char *>(&size), reinterpret_cast<const char *>(&size) + kSizeOfSizeT, value + kSizeOfOverflowPrefix);
+    std::copy(reinterpret_cast<const char *>(&page_id), reinterpret_cast<const char *>(&page_id) + kSizeOfSizeT, value + kSizeOfOverflowPrefix + kSizeOfSizeT);
+}
+
+// The whole value behind an overflow pointer, or only its inline prefix when
+// fetch is false.
+std::string deserializeOverflow(const char *value, bool fetch)
+{
+    std::string str(value, kSizeOfOverflowPrefix);
+    if (fetch)
+    {
+        str.resize(*reinterpret_cast<const size_t *>(value + kSizeOfOverflowPrefix));
+        readOverflow(overflowPageId(value), str.size() - kSizeOfOverflowPrefix, &str[kSizeOfOverflowPrefix]);
+    }
+    return str;
+}
+
+size_t overflowPageId(const char *value)
+{
+    return *reinterpret_cast<const size_t *>(value + kSizeOfOverflowPrefix + kSizeOfSizeT);
+}
+
+bool hasOverflow(const TableSchema &table_schema)
+{
+    size_t threshold = overflowThreshold(table_schema.column_schema_map);
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (i.second.varchar && i.second.data_type > threshold)
+            return true;
+    }
+    return false;
+}
+
+// Frees the overflow chains of a record of table_schema.
+void freeRowOverflow(const char *value, const TableSchema &table_schema)
+{
+    const char *row = value + kSizeOfBool + kSizeOfSizeT;
+    size_t bitmap_pos, fixed_pos, pos;
+    rowLayout(table_schema, &bitmap_pos, &fixed_pos, &pos);
+    for (size_t i = 0; i < table_schema.column_order_vector.size(); ++i)
+    {
+        const ColumnSchema &column_schema = table_schema.column_schema_map.at(table_schema.column_order_vector[i]);
+        if (!column_schema.varchar || row[bitmap_pos + i / 8] & (1 << i % 8))
+            continue;
+        uint16_t length;
+        memcpy(&length, row + pos, kSizeOfVarcharLength);
+        pos += kSizeOfVarcharLength;
+        if (length == kOverflowLength)
+        {
+            freeOverflow(overflowPageId(row + pos));
+            pos += kSizeOfOverflowPointer;
+        }
+        else
+            pos += length;
+    }
+}
+
+// A DICTIONARY column stores the index of its value in dictionary_vector.
+// dictionary_map is not persisted and is rebuilt on first use. Returns -1
+// for a value not in the dictionary.
+size_t dictionaryCode(const ColumnSchema &column_schema, const std::string &value)
+{
+    if (column_schema.dictionary_map.size() != column_schema.dictionary_vector.size())
+    {
+        column_schema.dictionary_map.clear();
+        for (size_t i = 0; i < column_schema.dictionary_vector.size(); ++i)
+            column_schema.dictionary_map[column_schema.dictionary_vector[i]] = i;
+    }
+    const auto &iter = column_schema.dictionary_map.find(value);
+    return iter == column_schema.dictionary_map.end() ? -1 : iter->second;
+}
+
+size_t addDictionaryValue(ColumnSchema &column_schema, const std::string &value)
+{
+    size_t code = dictionaryCode(column_schema, value);
+    if (code != -1)
+        return code;
+    if (column_schema.dictionary_vector.size() == kMaxDictionarySize)
+        throw Error(kDataOverFlowError, "");
+    column_schema.dictionary_vector.push_back(value);
+    column_schema.dictionary_map[value] = column_schema.dictionary_vector.size() - 1;
+    return column_schema.dictionary_vector.size() - 1;
+}
+
+// Collects the conditions of condition_vector that compare a DICTIONARY
+// column of table_schema to a string, so that a scan can test them on the
+// stored codes before decoding a row. Returns false when such a string is in
+// no dictionary, as then no row matches. A COLUMNAR table has no rows to
+// test.
+bool dictionaryFilter(const TableSchema &table_schema, const std::vector<Node> &condition_vector, std::vector<DictionaryFilter> *filter_vector)
+{
+    if (table_schema.columnar)
+        return true;
+    for (auto &&i : condition_vector)
+    {
+        if (i.token.token_type != kEqual)
+            continue;
+        const Node *name_node = &i.children.front(), *value_node = &i.children.back();
+        if (name_node->token.token_type != kName)
+            std::swap(name_node, value_node);
+        if (name_node->token.token_type != kName || value_node->token.token_type != kString)
+            continue;
+        const auto &column_schema_iter = table_schema.column_schema_map.find(name_node->children.back().token.str);
+        if (column_schema_iter == table_schema.column_schema_map.end() || !column_schema_iter->second.dictionary)
+            continue;
+        size_t code = dictionaryCode(column_schema_iter->second, value_node->token.str);
+        if (code == -1)
+            return false;
+        size_t bitmap_pos, code_pos, varchar_pos;
+        rowLayout(table_schema, &bitmap_pos, &code_pos, &varchar_pos);
+        size_t column = 0;
+        for (; table_schema.column_order_vector[column] != column_schema_iter->first; ++column)
+        {
+            const ColumnSchema &column_schema = table_schema.column_schema_map.at(table_schema.column_order_vector[column]);
+            if (!column_schema.varchar)
+                code_pos += fixedColumnSize(column_schema);
         }
+        filter_vector->push_back({code_pos, static_cast<uint16_t>(code), bitmap_pos + column / 8, static_cast<char>(1 << column % 8)});
     }
+    return true;
+}
+
+bool matchDictionaryFilter(const char *value, const std::vector<DictionaryFilter> &filter_vector)
+{
+    const char *row = value + kSizeOfBool + kSizeOfSizeT;
+    for (auto &&i : filter_vector)
+    {
+        if (row[i.null_pos] & i.null_mask || memcmp(row + i.code_pos, &i.code, kSizeOfDictionaryCode))
+            return false;
+    }
+    return true;
+}
+
+// The width of an INT or CHAR column in a row.
+size_t fixedColumnSize(const ColumnSchema &column_schema)
+{
+    return column_schema.data_type == 0 ? kSizeOfLong : column_schema.dictionary ? kSizeOfDictionaryCode : column_schema.data_type;
+}
+
+// Rows of a table start with a null bitmap with a bit per column in column
+// order, then the INT and CHAR columns in column order and last the VARCHAR
+// ones. A DICTIONARY CHAR takes only the width of its code. A NULL INT or
+// CHAR keeps its width zeroed. A VARCHAR is a two byte length and its bytes,
+// none when it is NULL, or kOverflowLength and an overflow pointer.
+void rowLayout(const TableSchema &table_schema, size_t *bitmap_pos, size_t *fixed_pos, size_t *varchar_pos)
+{
+    *bitmap_pos = 0;
+    *fixed_pos = (table_schema.column_schema_map.size() + 7) / 8;
+    *varchar_pos = *fixed_pos;
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (!i.second.varchar)
+            *varchar_pos += fixedColumnSize(i.second);
+    }
+}
+
+// Lays out a row of table_schema from its values in column order, as
+// rowLayout describes. A VARCHAR value keeps at most its declared width, and
+// one longer than overflowThreshold is replaced by an overflow pointer. The
+// value of a DICTIONARY column must already be in its dictionary. Returns the
+// size of the row.
+size_t serializeRow(const std::vector<Token> &values, const TableSchema &table_schema, char *row)
+{
+    size_t bitmap_pos, fixed_pos, varchar_pos;
+    rowLayout(table_schema, &bitmap_pos, &fixed_pos, &varchar_pos);
+    memset(row + bitmap_pos, 0, fixed_pos - bitmap_pos);
+    size_t threshold = overflowThreshold(table_schema.column_schema_map);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        const ColumnSchema &column_schema = table_schema.column_schema_map.at(table_schema.column_order_vector[i]);
+        size_t size = column_schema.data_type;
+        bool null = values[i].token_type == kNull;
+        if (null)
+            row[bitmap_pos + i / 8] |= 1 << i % 8;
+        if (size == 0)
+        {
+            long num = null ? 0 : values[i].num;
+            memcpy(row + fixed_pos, &num, kSizeOfLong);
+            fixed_pos += kSizeOfLong;
+        }
+        else if (column_schema.dictionary)
+        {
+            uint16_t code = null ? 0 : dictionaryCode(column_schema, values[i].str.substr(0, size));
+            memcpy(row + fixed_pos, &code, kSizeOfDictionaryCode);
+            fixed_pos += kSizeOfDictionaryCode;
+        }
+        else if (!column_schema.varchar)
+        {
+            size_t length = null ? 0 : std::min(values[i].str.size(), size);
+            std::copy(values[i].str.c_str(), values[i].str.c_str() + length, row + fixed_pos);
+            memset(row + fixed_pos + length, '\0', size - length);
+            fixed_pos += size;
+        }
+        else if (!null)
+        {
+            size_t length = std::min(values[i].str.size(), size);
+            uint16_t stored = length > threshold ? kOverflowLength : length;
+            memcpy(row + varchar_pos, &stored, kSizeOfVarcharLength);
+            varchar_pos += kSizeOfVarcharLength;
+            if (stored == kOverflowLength)
+            {
+                serializeOverflow(values[i].str.c_str(), length, row + varchar_pos);
+                varchar_pos += kSizeOfOverflowPointer;
+            }
+            else
+            {
+                std::copy(values[i].str.c_str(), values[i].str.c_str() + length, row + varchar_pos);
+                varchar_pos += length;
+            }
+        }
+    }
+    return varchar_pos;
+}
+
+// Keys are encoded so that memcmp orders them: a flag byte that is 0 for NULL
+// and 1 otherwise, then an INT as a big-endian long with its sign bit flipped
+// or a CHAR as its zero-padded bytes. Ids use the same big-endian form, and a
+// row key is an id behind a set flag byte.
+void serializeKey(const Token &value, size_t size, char *key)
+{
+    if (value.token_type == kNull)
+    {
+        key[0] = 0;
+        memset(key + kSizeOfBool, '\0', size);
+        return;
+    }
+    key[0] = 1;
+    if (value.token_type == kNum)
+        serializeId(static_cast<size_t>(value.num), key + kSizeOfBool);
+    else
+    {
+        size_t length = std::min(value.str.size(), size);
+        std::copy(value.str.c_str(), value.str.c_str() + length, key + kSizeOfBool);
+        memset(key + kSizeOfBool + length, '\0', size - length);
+    }
+}
+
+void serializeId(size_t id, char *key)
+{
+    size_t value = id ^ (static_cast<size_t>(1) << (kSizeOfSizeT * 8 - 1));
+    for (size_t i = 0; i < kSizeOfSizeT; ++i)
+        key[i] = static_cast<char>(value >> ((kSizeOfSizeT - 1 - i) * 8));
+}
+
+size_t deserializeId(const char *key)
+{
+    size_t value = 0;
+    for (size_t i = 0; i < kSizeOfSizeT; ++i)
+        value = value << 8 | static_cast<unsigned char>(key[i]);
+    return value ^ (static_cast<size_t>(1) << (kSizeOfSizeT * 8 - 1));
+}
+
+void serializeRowKey(size_t id, char *key)
+{
+    key[0] = 1;
+    serializeId(id, key + kSizeOfBool);
 }
 
 bool isNumber(const std::string &s)
@@ -246,7 +567,7 @@ Node eval(const Node &node, const std::unordered_map<std::string, std::unordered
             return Node(Token(kNull, "NULL"));
         else if (left_node.token.token_type == kString && right_node.token.token_type == kString)
         {
-            long result = left_node.token.str != right_node.token.str;
+            long result = left_node.token.str < right_node.token.str;
             return Node(Token(kNum, std::to_string(result), result));
         }
         else if (!remain)
@@ -272,7 +593,7 @@ Node eval(const Node &node, const std::unordered_map<std::string, std::unordered
             return Node(Token(kNull, "NULL"));
         else if (left_node.token.token_type == kString && right_node.token.token_type == kString)
         {
-            long result = left_node.token.str != right_node.token.str;
+            long result = left_node.token.str > right_node.token.str;
             return Node(Token(kNum, std::to_string(result), result));
         }
         else if (!remain)
@@ -298,7 +619,7 @@ Node eval(const Node &node, const std::unordered_map<std::string, std::unordered
             return Node(Token(kNull, "NULL"));
         else if (left_node.token.token_type == kString && right_node.token.token_type == kString)
         {
-            long result = left_node.token.str != right_node.token.str;
+            long result = left_node.token.str <= right_node.token.str;
             return Node(Token(kNum, std::to_string(result), result));
         }
         else if (!remain)
@@ -324,7 +645,7 @@ Node eval(const Node &node, const std::unordered_map<std::string, std::unordered
             return Node(Token(kNull, "NULL"));
         else if (left_node.token.token_type == kString && right_node.token.token_type == kString)
         {
-            long result = left_node.token.str != right_node.token.str;
+            long result = left_node.token.str >= right_node.token.str;
             return Node(Token(kNum, std::to_string(result), result));
         }
         else if (!remain)
@@ -745,59 +1066,381 @@ void getTableSet(const Node &expr_node, std::unordered_set<std::string> *table_s
     }
 }
 
-std::unordered_map<std::string, Token> toTokenMap(const char *value, const TableSchema &table_schema, size_t key_size, size_t *id)
+void getColumnSet(const Node &expr_node, std::unordered_map<std::string, std::unordered_set<std::string>> *column_set_map_ptr)
 {
-    size_t pos = 0;
-    pos += kSizeOfBool;
-    *id = *reinterpret_cast<const size_t *>(value + pos);
-    pos += kSizeOfSizeT;
+    if (expr_node.token.token_type == kName)
+    {
+        (*column_set_map_ptr)[expr_node.children.front().token.str].insert(expr_node.children.back().token.str);
+    }
+    else if (expr_node.token.token_type != kNum && expr_node.token.token_type != kNull && expr_node.token.token_type != kString)
+    {
+        for (auto &&i : expr_node.children)
+        {
+            getColumnSet(i, column_set_map_ptr);
+        }
+    }
+}
+
+// Overflowed values of columns outside column_set keep only their prefix, so
+// a scan reads no overflow page for a column it does not use. An overflowed
+// value keeps the first page of its chain in overflow_page_id, so that a
+// result row can point at the chain rather than copy it.
+std::unordered_map<std::string, Token> toTokenMap(const char *value, const TableSchema &table_schema, size_t key_size, size_t *id, const std::unordered_set<std::string> *column_set)
+{
+    *id = deserializeId(value + kSizeOfBool);
+    const char *row = value + kSizeOfBool + kSizeOfSizeT;
+    size_t bitmap_pos, fixed_pos, varchar_pos;
+    rowLayout(table_schema, &bitmap_pos, &fixed_pos, &varchar_pos);
     std::unordered_map<std::string, Token> column_token_map;
-    for (const auto &column_name : table_schema.column_order_vector)
+    for (size_t i = 0; i < table_schema.column_order_vector.size(); ++i)
     {
-        int data_type = table_schema.column_schema_map.at(column_name).data_type;
-        if (*reinterpret_cast<const bool *>(value + pos))
+        const std::string &column_name = table_schema.column_order_vector[i];
+        const ColumnSchema &column_schema = table_schema.column_schema_map.at(column_name);
+        size_t size = column_schema.data_type;
+        bool null = row[bitmap_pos + i / 8] & (1 << i % 8);
+        Token token{null ? kNull : size == 0 ? kNum : kString};
+        if (size == 0)
         {
-            column_token_map[column_name] = Token(kNull);
-            pos += kSizeOfBool;
-            pos += data_type == 0 ? kSizeOfLong : data_type;
-            continue;
+            if (!null)
+            {
+                memcpy(&token.num, row + fixed_pos, kSizeOfLong);
+                token.str = std::to_string(token.num);
+            }
+            fixed_pos += kSizeOfLong;
         }
-        else
-            pos += kSizeOfBool;
-        if (data_type == 0)
+        else if (column_schema.dictionary)
         {
-            Token token{kNum};
-            long num = *reinterpret_cast<const long *>(value + pos);
-            pos += kSizeOfLong;
-            token.str = std::to_string(num);
-            token.num = num;
-            column_token_map[column_name] = token;
+            if (!null)
+            {
+                uint16_t code;
+                memcpy(&code, row + fixed_pos, kSizeOfDictionaryCode);
+                token.str = column_schema.dictionary_vector[code];
+            }
+            fixed_pos += kSizeOfDictionaryCode;
         }
-        else
+        else if (!column_schema.varchar)
         {
-            Token token{kString};
-            token.str = reinterpret_cast<const char *>(value + pos);
-            pos += data_type;
-            column_token_map[column_name] = token;
+            if (!null)
+                token.str.assign(row + fixed_pos, strnlen(row + fixed_pos, size));
+            fixed_pos += size;
+        }
+        else if (!null)
+        {
+            uint16_t length;
+            memcpy(&length, row + varchar_pos, kSizeOfVarcharLength);
+            varchar_pos += kSizeOfVarcharLength;
+            if (length == kOverflowLength)
+            {
+                token.str = deserializeOverflow(row + varchar_pos, !column_set || column_set->count(column_name));
+                token.overflow_page_id = overflowPageId(row + varchar_pos);
+                varchar_pos += kSizeOfOverflowPointer;
+            }
+            else
+            {
+                token.str.assign(row + varchar_pos, length);
+                varchar_pos += length;
+            }
+        }
+        column_token_map[column_name] = token;
+    }
+    return column_token_map;
+}
+
+// A COLUMNAR table keeps each column in a tree of its own, keyed like the
+// table tree, whose value is a flag byte that is 0 for NULL and the column in
+// its row form: a long, the zero-padded CHAR or its dictionary code.
+size_t columnValueSize(const ColumnSchema &column_schema)
+{
+    if (column_schema.data_type == 0)
+        return kSizeOfBool + kSizeOfLong;
+    return kSizeOfBool + (column_schema.dictionary ? kSizeOfDictionaryCode : column_schema.data_type);
+}
+
+void serializeColumnValue(const Token &value, const ColumnSchema &column_schema, char *column_value)
+{
+    size_t size = columnValueSize(column_schema) - kSizeOfBool;
+    memset(column_value, 0, kSizeOfBool + size);
+    if (value.token_type == kNull)
+        return;
+    column_value[0] = 1;
+    if (column_schema.data_type == 0)
+        memcpy(column_value + kSizeOfBool, &value.num, kSizeOfLong);
+    else if (column_schema.dictionary)
+    {
+        uint16_t code = dictionaryCode(column_schema, value.str.substr(0, column_schema.data_type));
+        memcpy(column_value + kSizeOfBool, &code, kSizeOfDictionaryCode);
+    }
+    else
+        memcpy(column_value + kSizeOfBool, value.str.c_str(), std::min(value.str.size(), size));
+}
+
+Token deserializeColumnValue(const char *column_value, const ColumnSchema &column_schema)
+{
+    if (!column_value[0])
+        return Token(kNull);
+    Token token{column_schema.data_type == 0 ? kNum : kString};
+    if (column_schema.data_type == 0)
+    {
+        memcpy(&token.num, column_value + kSizeOfBool, kSizeOfLong);
+        token.str = std::to_string(token.num);
+    }
+    else if (column_schema.dictionary)
+    {
+        uint16_t code;
+        memcpy(&code, column_value + kSizeOfBool, kSizeOfDictionaryCode);
+        token.str = column_schema.dictionary_vector[code];
+    }
+    else
+        token.str.assign(column_value + kSizeOfBool, strnlen(column_value + kSizeOfBool, column_schema.data_type));
+    return token;
+}
+
+// Looks the rows of key_vector up in the column trees of a COLUMNAR table.
+// Columns outside column_set are left NULL.
+std::vector<std::unordered_map<std::string, Token>> columnTokenMaps(const TableSchema &table_schema, const std::vector<char *> &key_vector, const std::unordered_set<std::string> *column_set)
+{
+    std::vector<std::unordered_map<std::string, Token>> column_map_vector(key_vector.size());
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (column_set && column_set->find(i.first) == column_set->end())
+        {
+            for (auto &&column_map : column_map_vector)
+                column_map[i.first] = Token(kNull);
+            continue;
+        }
+        std::vector<RecordPtr> record_vector = BPlusTreeMultiSearch(i.second.column_root_page_id, key_vector, false);
+        for (size_t k = 0; k < key_vector.size(); ++k)
+            column_map_vector[k][i.first] = deserializeColumnValue(record_vector[k] + kSizeOfBool + kSizeOfSizeT, i.second);
+    }
+    return column_map_vector;
+}
+
+ColumnCursor::ColumnCursor(const TableSchema &table_schema, const std::unordered_set<std::string> *column_set, char *begin_key, char *end_key)
+{
+    for (auto &&i : table_schema.column_schema_map)
+    {
+        if (column_set && column_set->find(i.first) == column_set->end())
+        {
+            null_column_vector_.push_back(i.first);
+            continue;
         }
+        column_vector_.push_back({i.first, &i.second});
+        iter_vector_.push_back(BPlusTreeSelect(i.second.column_root_page_id, begin_key, end_key, false).begin());
     }
+}
+
+std::unordered_map<std::string, Token> ColumnCursor::next()
+{
+    std::unordered_map<std::string, Token> column_token_map;
+    for (size_t i = 0; i < column_vector_.size(); ++i)
+    {
+        column_token_map[column_vector_[i].first] = deserializeColumnValue(*iter_vector_[i] + kSizeOfBool + kSizeOfSizeT, *column_vector_[i].second);
+        ++iter_vector_[i];
+    }
+    for (auto &&i : null_column_vector_)
+        column_token_map[i] = Token(kNull);
     return column_token_map;
 }
 
-std::vector<Token> toTokenResultVector(const char *value, const std::vector<int> data_type_vector, size_t key_size)
+std::vector<std::string> zoneColumnVector(const TableSchema &table_schema)
+{
+    std::vector<std::string> column_vector;
+    for (auto &&i : table_schema.column_order_vector)
+    {
+        if (table_schema.column_schema_map.at(i).zone_map)
+            column_vector.push_back(i);
+    }
+    return column_vector;
+}
+
+size_t zoneValueSize(const TableSchema &table_schema)
+{
+    return kOffsetOfZoneRange + zoneColumnVector(table_schema).size() * 2 * kSizeOfLong;
+}
+
+// A column with no value in the zone has its least value above its greatest.
+void emptyZone(const TableSchema &table_schema, const char *begin_key, char *zone_value)
+{
+    std::copy(begin_key, begin_key + kSizeOfBool + kSizeOfSizeT, zone_value);
+    *reinterpret_cast<size_t *>(zone_value + kOffsetOfZoneCount) = 0;
+    long *range = reinterpret_cast<long *>(zone_value + kOffsetOfZoneRange);
+    for (size_t i = 0; i < zoneColumnVector(table_schema).size(); ++i)
+    {
+        range[2 * i] = std::numeric_limits<long>::max();
+        range[2 * i + 1] = std::numeric_limits<long>::min();
+    }
+}
+
+void widenZone(const TableSchema &table_schema, const std::unordered_map<std::string, Token> &column_token_map, char *zone_value)
+{
+    ++*reinterpret_cast<size_t *>(zone_value + kOffsetOfZoneCount);
+    long *range = reinterpret_cast<long *>(zone_value + kOffsetOfZoneRange);
+    for (auto &&i : zoneColumnVector(table_schema))
+    {
+        const Token &token = column_token_map.at(i);
+        if (token.token_type == kNum)
+        {
+            range[0] = std::min(range[0], token.num);
+            range[1] = std::max(range[1], token.num);
+        }
+        range += 2;
+    }
+}
+
+// Sums the rows of a zone up again, from the key it begins at to end_key.
+void summarizeZone(const TableSchema &table_schema, const char *end_key, char *zone_value)
+{
+    std::vector<char> begin_key(zone_value, zone_value + kSizeOfBool + kSizeOfSizeT);
+    emptyZone(table_schema, begin_key.data(), zone_value);
+    std::vector<std::string> column_vector = zoneColumnVector(table_schema);
+    std::unordered_set<std::string> column_set(column_vector.begin(), column_vector.end());
+    std::unique_ptr<ColumnCursor> column_cursor;
+    if (table_schema.columnar)
+        column_cursor.reset(new ColumnCursor(table_schema, &column_set, begin_key.data(), nullptr));
+    for (auto &&iter : BPlusTreeSelect(table_schema.root_page_id, begin_key.data(), nullptr, false))
+    {
+        if (memcmp(iter, end_key, kSizeOfBool + kSizeOfSizeT) >= 0)
+            break;
+        size_t id = -1;
+        widenZone(table_schema, column_cursor ? column_cursor->next() : toTokenMap(iter, table_schema, kSizeOfSizeT, &id, &column_set), zone_value);
+    }
+}
+
+// The zone of key is the first to end above it. The last zone ends above
+// every key, so only a key past that end finds none.
+std::vector<char> findZone(const TableSchema &table_schema, char *key)
+{
+    size_t pos = kOffsetOfPageHeader;
+    Iter iter({BPlusTreeTraverse(table_schema.zone_root_page_id, key, true, 0, false, &pos), pos});
+    const char *zone = *iter;
+    if (!zone)
+        return {};
+    return std::vector<char>(zone, zone + kSizeOfBool + kSizeOfSizeT + zoneValueSize(table_schema));
+}
+
+// Bounds each ZONEMAP column by the conditions that compare it with a
+// number. Fails when the bounds of a column leave no value.
+bool zoneFilter(const TableSchema &table_schema, const std::vector<Node> &condition_vector, std::vector<ZoneFilter> *filter_vector)
+{
+    if (table_schema.zone_root_page_id == -1)
+        return true;
+    std::vector<std::string> column_vector = zoneColumnVector(table_schema);
+    for (auto &&i : condition_vector)
+    {
+        TokenType token_type = i.token.token_type;
+        if (token_type != kEqual && token_type != kLess && token_type != kLessEqual && token_type != kGreater && token_type != kGreaterEqual)
+            continue;
+        const Node *name_node = &i.children.front(), *value_node = &i.children.back();
+        if (name_node->token.token_type != kName)
+        {
+            std::swap(name_node, value_node);
+            if (token_type == kLess)
+                token_type = kGreater;
+            else if (token_type == kLessEqual)
+                token_type = kGreaterEqual;
+            else if (token_type == kGreater)
+                token_type = kLess;
+            else if (token_type == kGreaterEqual)
+                token_type = kLessEqual;
+        }
+        if (name_node->token.token_type != kName || value_node->token.token_type != kNum)
+            continue;
+        auto column_iter = std::find(column_vector.begin(), column_vector.end(), name_node->children.back().token.str);
+        if (column_iter == column_vector.end())
+            continue;
+        long num = value_node->token.num;
+        long low = std::numeric_limits<long>::min(), high = std::numeric_limits<long>::max();
+        if ((token_type == kLess && num == low) || (token_type == kGreater && num == high))
+            return false;
+        if (token_type == kEqual || token_type == kGreaterEqual)
+            low = num;
+        if (token_type == kEqual || token_type == kLessEqual)
+            high = num;
+        if (token_type == kGreater)
+            low = num + 1;
+        if (token_type == kLess)
+            high = num - 1;
+        size_t range_pos = kOffsetOfZoneRange + (column_iter - column_vector.begin()) * 2 * kSizeOfLong;
+        auto filter_iter = std::find_if(filter_vector->begin(), filter_vector->end(), [range_pos](const ZoneFilter &filter) { return filter.range_pos == range_pos; });
+        if (filter_iter == filter_vector->end())
+        {
+            filter_vector->push_back(ZoneFilter{range_pos, low, high});
+            filter_iter = filter_vector->end() - 1;
+        }
+        filter_iter->low = std::max(filter_iter->low, low);
+        filter_iter->high = std::min(filter_iter->high, high);
+        if (filter_iter->low > filter_iter->high)
+            return false;
+    }
+    return true;
+}
+
+bool matchZoneFilter(const char *zone_value, const std::vector<ZoneFilter> &filter_vector)
+{
+    for (auto &&i : filter_vector)
+    {
+        const long *range = reinterpret_cast<const long *>(zone_value + i.range_pos);
+        if (range[0] > i.high || range[1] < i.low)
+            return false;
+    }
+    return true;
+}
+
+// The runs of adjacent zones that a scan from begin_key to end_key has to
+// read, each as the key it begins at and the key it ends before. Without a
+// filter the scan reads one run, left empty.
+std::vector<std::pair<std::string, std::string>> zoneRuns(const TableSchema &table_schema, const std::vector<ZoneFilter> &filter_vector, char *begin_key, char *end_key)
+{
+    size_t key_size = kSizeOfBool + kSizeOfSizeT;
+    std::vector<std::pair<std::string, std::string>> run_vector;
+    if (filter_vector.empty())
+    {
+        run_vector.emplace_back();
+        return run_vector;
+    }
+    size_t pos = kOffsetOfPageHeader;
+    Iter iter = begin_key ? Iter({BPlusTreeTraverse(table_schema.zone_root_page_id, begin_key, true, 0, false, &pos), pos}) : BPlusTreeSelect(table_schema.zone_root_page_id, nullptr, nullptr, false).begin();
+    for (const char *zone; (zone = *iter) != nullptr; ++iter)
+    {
+        const char *zone_value = zone + key_size;
+        if (end_key && memcmp(zone_value, end_key, key_size) > 0)
+            break;
+        if (!matchZoneFilter(zone_value, filter_vector))
+            continue;
+        if (!run_vector.empty() && run_vector.back().second.compare(0, key_size, zone_value, key_size) == 0)
+            run_vector.back().second.assign(zone, key_size);
+        else
+            run_vector.push_back({std::string(zone_value, key_size), std::string(zone, key_size)});
+    }
+    return run_vector;
+}
+
+// A result row is read once, so the overflow chains it owns are freed as it
+// is read. Those it points at belong to their tables.
+std::vector<Token> toTokenResultVector(const char *value, const std::vector<int> data_type_vector, const std::vector<size_t> &value_size_vector, size_t key_size)
 {
     size_t pos = 0;
     pos += kSizeOfBool;
-    size_t id = *reinterpret_cast<const size_t *>(value + pos);
     pos += kSizeOfSizeT;
     std::vector<Token> token_vector;
-    for (const auto &data_type : data_type_vector)
+    for (size_t i = 0; i < data_type_vector.size(); ++i)
     {
-        if (*reinterpret_cast<const bool *>(value + pos))
+        int data_type = data_type_vector[i];
+        if (value[pos] == kOverflowFlag || value[pos] == kOverflowReferenceFlag)
+        {
+            Token token{kString};
+            token.str = deserializeOverflow(value + pos + kSizeOfBool, true);
+            if (value[pos] == kOverflowFlag)
+                freeOverflow(overflowPageId(value + pos + kSizeOfBool));
+            pos += kSizeOfBool + value_size_vector[i];
+            token_vector.push_back(token);
+            continue;
+        }
+        if (value[pos])
         {
             token_vector.push_back(Token(kNull));
             pos += kSizeOfBool;
-            pos += data_type == 0 ? kSizeOfLong : data_type;
+            pos += value_size_vector[i];
             continue;
         }
         else
@@ -814,45 +1457,10 @@ std::vector<Token> toTokenResultVector(const char *value, const std::vector<int>
         else
         {
             Token token{kString};
-            token.str = reinterpret_cast<const char *>(value + pos);
-            pos += data_type;
+            token.str.assign(value + pos, strnlen(value + pos, value_size_vector[i]));
+            pos += value_size_vector[i];
             token_vector.push_back(token);
         }
     }
     return token_vector;
 }
-
-int compareInt(char *lhs, char *rhs, size_t size)
-{
-    if (!*reinterpret_cast<const bool *>(lhs) && !*reinterpret_cast<const bool *>(rhs))
-    {
-        long lhs_value = *reinterpret_cast<const long *>(lhs + kSizeOfBool);
-        long rhs_value = *reinterpret_cast<const long *>(rhs + kSizeOfBool);
-        if (lhs_value == rhs_value)
-        {
-            if (size == kSizeOfLong + kSizeOfBool)
-                return 0;
-            else
-            {
-                return std::memcmp(lhs, rhs, size);
-            }
-        }
-        else if (lhs_value < rhs_value)
-            return -1;
-        else
-            return 1;
-    }
-    else if (*reinterpret_cast<const bool *>(lhs) && *reinterpret_cast<const bool *>(rhs))
-    {
-        return 0;
-    }
-    else if (*reinterpret_cast<const bool *>(lhs))
-        return -1;
-    else
-        return 1;
-}
-
-int compareString(char *lhs, char *rhs, size_t size)
-{
-    return std::memcmp(lhs, rhs, size);
-}
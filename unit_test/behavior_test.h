@@ -0,0 +1,964 @@
+#ifndef BEHAVIOR_TEST_H_
+#define BEHAVIOR_TEST_H_
+
+#include "lexer.h"
+#include "parser.h"
+#include "gdbe.h"
+#include "page_codec.h"
+#include "simd_search.h"
+#include <unistd.h>
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace unittest
+{
+const std::string kBehaviorTestDir = "behavior_test_data";
+
+// Runs statements against the engine in a scratch directory and checks what
+// they do, not only that they parse. Every test works in a database of its
+// own, so the tests share the buffer pool like databases of one session do.
+class BehaviorTest
+{
+private:
+    Lexer lexer_;
+    Parser parser_;
+    size_t failure_count_ = 0;
+
+    // The rows of the result of sql, all pages of a SELECT included. An error
+    // comes back as one row holding "error" and its message.
+    std::vector<std::vector<std::string>> query(const std::string &sql)
+    {
+        std::vector<std::vector<std::string>> rows;
+        GDBE &gdbe = GDBE::getInstance();
+        try
+        {
+            gdbe.exec(parser_.parse(lexer_.lex(sql)));
+            Result result;
+            while ((result = gdbe.getResult()))
+                rows.insert(rows.end(), result.string_vector_vector.begin(), result.string_vector_vector.end());
+        }
+        catch (const Error &error)
+        {
+            rows.push_back({"error", error.what()});
+        }
+        return rows;
+    }
+    void insertRows(const std::string &table_name, size_t begin, size_t end, const std::string &value)
+    {
+        for (size_t i = begin; i < end; i += 50)
+        {
+            std::string sql = "INSERT INTO " + table_name + " VALUES";
+            for (size_t j = i; j < std::min(i + 50, end); ++j)
+                sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + ",'" + value + std::to_string(j) + "')";
+            query(sql + ";");
+        }
+    }
+    void copyFile(const std::string &from, const std::string &to)
+    {
+        std::ifstream in(from, std::ifstream::binary);
+        std::ofstream out(to, std::ofstream::binary);
+        out << in.rdbuf();
+    }
+    // A tree of tree_id mapping each row key of id_vector to its id.
+    size_t buildIdTree(size_t tree_id, const std::vector<size_t> &id_vector)
+    {
+        size_t key_size = kSizeOfBool + kSizeOfSizeT;
+        size_t root_page_id = createNewPage(PageSchema(true, 0, -1, -1, key_size, key_size, kSizeOfSizeT, tree_id));
+        std::vector<char> key(key_size);
+        for (size_t id : id_vector)
+        {
+            serializeRowKey(id, key.data());
+            BPlusTreeInsert(root_page_id, key.data(), reinterpret_cast<char *>(&id), true, &root_page_id);
+        }
+        return root_page_id;
+    }
+    void expect(bool condition, const std::string &name)
+    {
+        if (condition)
+            return;
+        ++failure_count_;
+        std::cout << "FAIL: " << name << std::endl;
+    }
+
+public:
+    BehaviorTest()
+    {
+        fs::remove_all(kBehaviorTestDir);
+        fs::create_directory(kBehaviorTestDir);
+        if (chdir(kBehaviorTestDir.c_str()))
+            throw Error(kMemoryError, kBehaviorTestDir);
+    }
+    ~BehaviorTest()
+    {
+        if (chdir(".."))
+            return;
+        fs::remove_all(kBehaviorTestDir);
+    }
+    size_t failureCount() const
+    {
+        return failure_count_;
+    }
+    // A range DELETE drops whole subtrees and a TRUNCATE the whole tree, and
+    // both hand the pages back, so refilling the table barely grows the file.
+    void rangeDeleteTest()
+    {
+        query("CREATE DATABASE range_delete PAGE_SIZE = 4096;");
+        query("USE range_delete;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        query("CREATE INDEX i ON t(id);");
+        insertRows("t", 0, 2000, "v");
+        size_t file_size = FileSystem::getInstance().size();
+        query("DELETE FROM t WHERE id BETWEEN 100 AND 1899;");
+        auto rows = query("SELECT id FROM t WHERE id >= 0;");
+        bool outside = rows.size() == 200;
+        for (auto &&row : rows)
+            outside = outside && (std::stol(row.front()) < 100 || std::stol(row.front()) > 1899);
+        expect(outside, "range delete keeps only the rows outside the range");
+        insertRows("t", 2000, 3800, "v");
+        expect(FileSystem::getInstance().size() <= file_size + file_size / 10, "range delete frees the pages it removes");
+        expect(query("SELECT id FROM t WHERE id >= 2500 AND id <= 2509;").size() == 10, "index finds rows inserted after a range delete");
+        query("TRUNCATE TABLE t;");
+        expect(query("SELECT id FROM t;").empty(), "truncate removes every row");
+        insertRows("t", 0, 2000, "v");
+        expect(FileSystem::getInstance().size() <= file_size + file_size / 10, "truncate frees the pages of the table");
+        expect(query("SELECT id FROM t;").size() == 2000, "truncated table takes new rows");
+    }
+    // A large scan goes through the scan ring, so the pages a lookup keeps
+    // using are still cached after it.
+    void scanResistanceTest()
+    {
+        query("CREATE DATABASE scan_resistance PAGE_SIZE = 4096;");
+        query("USE scan_resistance;");
+        query("CREATE TABLE hot(id INT, val CHAR(200));");
+        query("CREATE INDEX i ON hot(id);");
+        insertRows("hot", 0, 100, "h");
+        query("CREATE TABLE big(id INT, val CHAR(200));");
+        insertRows("big", 0, 4000, "b");
+        query("SET BUFFER_POOL_SIZE = 64;");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        const std::string hot_sql = "SELECT id FROM hot WHERE id >= 0 AND id <= 99;";
+        query(hot_sql);
+        query(hot_sql);
+        size_t miss_count = buffer_pool.missCount();
+        query(hot_sql);
+        size_t warm_misses = buffer_pool.missCount() - miss_count;
+        expect(query("SELECT id FROM big;").size() == 4000, "scan reads the whole table");
+        miss_count = buffer_pool.missCount();
+        expect(query(hot_sql).size() == 100, "lookup after a scan finds its rows");
+        expect(buffer_pool.missCount() - miss_count <= warm_misses, "scan does not evict the pages of a hot lookup");
+        query("SET BUFFER_POOL_SIZE = 2000;");
+    }
+    // A PagePtr pins its frame for as long as a copy of it lives, a pinned
+    // page stays cached through a scan far larger than the pool, and no pin
+    // outlives the statement that took it.
+    void pinTest()
+    {
+        query("CREATE DATABASE pin PAGE_SIZE = 4096;");
+        query("USE pin;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        insertRows("t", 0, 2000, "p");
+        query("SET BUFFER_POOL_SIZE = 32;");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        expect(buffer_pool.pinnedCount() == 0, "statements release their pins");
+        {
+            PagePtr page_ptr = buffer_pool.getPage(0);
+            expect(page_ptr->pin_count == 1, "PagePtr pins its page");
+            PagePtr copy_ptr = page_ptr;
+            PagePtr move_ptr = std::move(copy_ptr);
+            expect(page_ptr->pin_count == 2 && !copy_ptr, "a copy pins again and a move does not");
+            expect(query("SELECT id FROM t;").size() == 2000, "scan with a page pinned reads every row");
+            expect(buffer_pool.peekPage(0) == page_ptr.get() && page_ptr->page_id == 0, "pinned page is not evicted");
+        }
+        expect(buffer_pool.pinnedCount() == 0, "PagePtr unpins when it goes away");
+        query("SET BUFFER_POOL_SIZE = 2000;");
+    }
+    // A frame keeps the decoded header of its page until the page is written.
+    void headerCacheTest()
+    {
+        query("CREATE DATABASE header_cache PAGE_SIZE = 4096;");
+        query("USE header_cache;");
+        size_t key_size = kSizeOfBool + kSizeOfSizeT;
+        size_t root_page_id = createNewPage(PageSchema(true, 0, -1, -1, key_size, key_size, kSizeOfSizeT, 7));
+        std::vector<char> key(key_size), value(kSizeOfSizeT);
+        for (size_t i = 0; i < 10; ++i)
+        {
+            serializeRowKey(i, key.data());
+            BPlusTreeInsert(root_page_id, key.data(), value.data(), true, &root_page_id);
+        }
+        Page *page = getPageHandle(root_page_id);
+        expect(page->header_valid && page->header.leaf && page->header.size == 10 && page->header.tree_id == 7, "decoded header matches the page");
+        expect(page->header.total_size == kOffsetOfPageHeader + 10 * (key_size + kSizeOfSizeT), "decoded header holds the end of the entries");
+        FileSystem::getInstance().write(root_page_id, PagePtr(page));
+        expect(!page->header_valid, "writing a page drops its decoded header");
+        serializeRowKey(10, key.data());
+        BPlusTreeInsert(root_page_id, key.data(), value.data(), true, &root_page_id);
+        page = getPageHandle(root_page_id);
+        expect(page->header.size == readHeaderField(page->buffer, kOffsetOfSize) && page->header.size == 11, "header is decoded again after an insert");
+        BPlusTreeRemove(root_page_id);
+    }
+    // SET BUFFER_POOL_SIZE grows or shrinks the pool a whole extent at a time
+    // and SHOW BUFFER POOL reports it; the cached pages never outnumber it.
+    void bufferPoolSizeTest()
+    {
+        query("CREATE DATABASE buffer_pool_size PAGE_SIZE = 4096;");
+        query("USE buffer_pool_size;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        insertRows("t", 0, 1000, "s");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        query("SET BUFFER_POOL_SIZE = 100;");
+        auto rows = query("SHOW BUFFER POOL;");
+        expect(!rows.empty() && rows.front().front() == "capacity" && rows.front().back() == std::to_string(buffer_pool.capacity()), "SHOW BUFFER POOL reports the capacity");
+        expect(buffer_pool.capacity() >= 100 && buffer_pool.capacity() < 116, "pool is resized to whole extents");
+        expect(query("SET BUFFER_POOL_SIZE = 0;").front().front() == "error", "pool size must be positive");
+        query("SET BUFFER_POOL_SIZE = 1;");
+        expect(buffer_pool.capacity() == 32, "pool keeps its minimum size");
+        expect(query("SELECT id FROM t;").size() == 1000, "scan through a small pool reads every row");
+        expect(buffer_pool.size() <= buffer_pool.capacity(), "pool caches no more pages than its capacity");
+        query("SET BUFFER_POOL_SIZE = 2000;");
+        expect(buffer_pool.capacity() >= 2000, "pool grows back");
+    }
+    // Databases of one session share the buffer pool, so switching back to a
+    // database finds its pages still cached.
+    void sharedPoolTest()
+    {
+        query("CREATE DATABASE shared_pool_a PAGE_SIZE = 4096;");
+        query("USE shared_pool_a;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        insertRows("t", 0, 300, "a");
+        query("CREATE DATABASE shared_pool_b PAGE_SIZE = 4096;");
+        query("USE shared_pool_b;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        insertRows("t", 0, 300, "b");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        query("USE shared_pool_a;");
+        query("SELECT id FROM t;");
+        query("USE shared_pool_b;");
+        query("SELECT id FROM t;");
+        size_t miss_count = buffer_pool.missCount();
+        query("USE shared_pool_a;");
+        auto rows = query("SELECT val FROM t WHERE id = 7;");
+        expect(rows.size() == 1 && rows.front().front() == "a7", "each database reads its own pages");
+        query("USE shared_pool_b;");
+        rows = query("SELECT val FROM t WHERE id = 7;");
+        expect(rows.size() == 1 && rows.front().front() == "b7", "pages of two databases do not mix");
+        expect(buffer_pool.missCount() == miss_count, "switching databases keeps their pages cached");
+    }
+    // Leaving a database dumps the ids of its cached pages and the first USE
+    // of a database reads them back ahead of the first statement. A damaged
+    // dump is ignored and one larger than the pool loads as much as fits.
+    void warmupTest()
+    {
+        query("SET BUFFER_POOL_SIZE = 4000;");
+        query("CREATE DATABASE warm PAGE_SIZE = 4096;");
+        query("USE warm;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        query("CREATE INDEX i ON t(id);");
+        insertRows("t", 0, 1000, "w");
+        query("SELECT id FROM t WHERE id >= 0 AND id <= 999;");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        FileSystem &file_system = FileSystem::getInstance();
+        size_t page_count = file_system.size() / file_system.pageSize();
+        size_t resident_count = buffer_pool.getResidentPages(file_system.getFileId()).size();
+        query("USE range_delete;");
+        for (auto &&name : {"warm_copy", "warm_damaged", "warm_oversized"})
+        {
+            copyFile(kDatabaseDir + "warm", kDatabaseDir + name);
+            copyFile(kWarmupDir + "warm", kWarmupDir + name);
+        }
+        query("USE warm_copy;");
+        expect(buffer_pool.getResidentPages(file_system.getFileId()).size() == resident_count, "first use of a database loads every page of its dump");
+        expect(query("SELECT id FROM t;").size() == 1000, "database reads correctly after a warmup");
+        std::vector<size_t> page_id_vector{3, 1, 2};
+        std::fstream file(kWarmupDir + "warm_damaged", std::fstream::out | std::fstream::binary | std::fstream::trunc);
+        file.write(reinterpret_cast<const char *>(&page_count), kSizeOfSizeT);
+        file.write(reinterpret_cast<const char *>(page_id_vector.data()), page_id_vector.size() * kSizeOfSizeT);
+        file.close();
+        query("USE warm_damaged;");
+        expect(buffer_pool.getResidentPages(file_system.getFileId()).size() < resident_count, "damaged dump is ignored");
+        expect(query("SELECT id FROM t;").size() == 1000, "database reads correctly after a damaged dump");
+        page_id_vector.clear();
+        for (size_t i = 0; i < buffer_pool.capacity() + 10; ++i)
+            page_id_vector.push_back(i % page_count);
+        size_t size = page_id_vector.size();
+        file.open(kWarmupDir + "warm_oversized", std::fstream::out | std::fstream::binary | std::fstream::trunc);
+        file.write(reinterpret_cast<const char *>(&size), kSizeOfSizeT);
+        file.write(reinterpret_cast<const char *>(page_id_vector.data()), size * kSizeOfSizeT);
+        file.close();
+        query("USE warm_oversized;");
+        expect(buffer_pool.getResidentPages(file_system.getFileId()).size() == page_count, "dump larger than the pool still loads");
+        query("SET BUFFER_POOL_SIZE = 2000;");
+    }
+    // A database opened with mmap maps its file and remaps it as it grows;
+    // what a statement reads is what the statements before it wrote.
+    void mmapTest()
+    {
+        FileSystem &file_system = FileSystem::getInstance();
+        file_system.setMmap(true);
+        query("CREATE DATABASE mapped PAGE_SIZE = 4096;");
+        query("USE mapped;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        query("CREATE INDEX i ON t(id);");
+        insertRows("t", 0, 3000, "m");
+        expect(query("SELECT id FROM t;").size() == 3000, "mapped file reads every row after it grows");
+        query("DELETE FROM t WHERE id = 1234;");
+        query("INSERT INTO t VALUES(1234,'changed');");
+        auto rows = query("SELECT val FROM t WHERE id = 1234;");
+        expect(rows.size() == 1 && rows.front().front() == "changed", "rewritten row is seen through the mapping");
+        query("DELETE FROM t WHERE id >= 1000 AND id < 2000;");
+        expect(query("SELECT id FROM t WHERE id >= 0;").size() == 2000, "delete is seen through the mapping");
+        query("USE range_delete;");
+        expect(query("DROP DATABASE mapped;").empty() && !fs::exists(kDatabaseDir + "mapped"), "mapped database drops");
+        file_system.setMmap(false);
+    }
+    // Each database keeps the page size it was created with. Frames grow to
+    // the largest page size in use, so small and large pages share the pool,
+    // and both read back the same through O_DIRECT.
+    void pageSizeTest()
+    {
+        expect(query("CREATE DATABASE odd_page PAGE_SIZE = 5000;").front().front() == "error", "page size must be a supported power of two");
+        FileSystem &file_system = FileSystem::getInstance();
+        for (bool direct_io : {false, true})
+        {
+            file_system.setDirectIo(direct_io);
+            for (size_t page_size : {4096, 65536})
+            {
+                std::string database_name = std::string(direct_io ? "direct_" : "buffered_") + std::to_string(page_size);
+                query("CREATE DATABASE " + database_name + " PAGE_SIZE = " + std::to_string(page_size) + ";");
+                query("USE " + database_name + ";");
+                query("CREATE TABLE t(id INT, val CHAR(200));");
+                query("CREATE INDEX i ON t(id);");
+                insertRows("t", 0, 1000, database_name);
+                expect(file_system.pageSize() == page_size && file_system.size() % page_size == 0, "database keeps its page size");
+            }
+            for (size_t page_size : {4096, 65536})
+            {
+                std::string database_name = std::string(direct_io ? "direct_" : "buffered_") + std::to_string(page_size);
+                query("USE " + database_name + ";");
+                auto rows = query("SELECT val FROM t WHERE id = 567;");
+                expect(rows.size() == 1 && rows.front().front() == database_name + "567", "pages of either size read back");
+                expect(query("SELECT id FROM t;").size() == 1000, "scan reads every page of either size");
+            }
+        }
+        file_system.setDirectIo(false);
+    }
+    // A scan from a cold pool reads the leaf chain ahead of the iterator, so
+    // most of its pages are already in flight when it reaches them.
+    void readAheadTest()
+    {
+        query("CREATE DATABASE read_ahead PAGE_SIZE = 4096;");
+        query("USE read_ahead;");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        insertRows("t", 0, 4000, "r");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        FileSystem &file_system = FileSystem::getInstance();
+        size_t page_count = file_system.size() / file_system.pageSize();
+        buffer_pool.clear(file_system.getFileId());
+        size_t miss_count = buffer_pool.missCount();
+        size_t read_ahead_count = buffer_pool.readAheadCount();
+        auto rows = query("SELECT id FROM t;");
+        bool ordered = rows.size() == 4000;
+        for (size_t i = 0; ordered && i < rows.size(); ++i)
+            ordered = rows[i].front() == std::to_string(i);
+        expect(ordered, "scan with read ahead returns every row in order");
+        expect(buffer_pool.readAheadCount() > read_ahead_count, "cold scan reads ahead");
+        expect(buffer_pool.missCount() - miss_count < page_count / 2, "cold scan waits for few of its pages");
+        expect(file_system.readsInFlight() == 0 && buffer_pool.pinnedCount() == 0, "scan leaves no read in flight");
+    }
+    // A multi-key lookup answers each key in the order it was asked, however
+    // the keys are ordered and whether or not they are in the tree.
+    void multiSearchTest()
+    {
+        query("CREATE DATABASE multi_search PAGE_SIZE = 4096;");
+        query("USE multi_search;");
+        std::vector<size_t> id_vector;
+        for (size_t i = 0; i < 6000; i += 2)
+            id_vector.push_back(i);
+        size_t root_page_id = buildIdTree(8, id_vector);
+        size_t key_size = kSizeOfBool + kSizeOfSizeT;
+        std::vector<std::vector<char>> key_buffer_vector;
+        std::vector<char *> key_vector;
+        for (size_t i = 0; i < 6100; i += 3)
+            key_buffer_vector.emplace_back(key_size);
+        for (size_t i = 0; i < key_buffer_vector.size(); ++i)
+        {
+            serializeRowKey((i * 7919) % key_buffer_vector.size() * 3, key_buffer_vector[i].data());
+            key_vector.push_back(key_buffer_vector[i].data());
+        }
+        key_vector.push_back(key_vector.front());
+        std::vector<RecordPtr> record_vector = BPlusTreeMultiSearch(root_page_id, key_vector, false);
+        bool match = record_vector.size() == key_vector.size();
+        for (size_t i = 0; match && i < key_vector.size(); ++i)
+        {
+            size_t id = (i == key_buffer_vector.size() ? 0 : i) * 7919 % key_buffer_vector.size() * 3;
+            RecordPtr record_ptr = BPlusTreeSearch(root_page_id, key_vector[i], false);
+            if (id % 2 != 0 || id >= 6000)
+                match = !record_vector[i] && !record_ptr;
+            else
+                match = record_vector[i] && *reinterpret_cast<const size_t *>(record_vector[i].record + key_size) == id && record_ptr && *reinterpret_cast<const size_t *>(record_ptr.record + key_size) == id;
+        }
+        expect(match, "multi-key lookup finds the keys of the tree in the order asked");
+        record_vector.clear();
+        BPlusTreeRemove(root_page_id);
+        expect(BufferPool::getInstance().pinnedCount() == 0, "multi-key lookup releases its pages");
+    }
+    // A row page hint only counts while the page is still a leaf of the tree
+    // it was taken from; a stale hint misses and the lookup falls back to the
+    // primary tree.
+    void rowHintTest()
+    {
+        query("CREATE DATABASE row_hint PAGE_SIZE = 4096;");
+        query("USE row_hint;");
+        std::vector<size_t> id_vector;
+        for (size_t i = 0; i < 3000; ++i)
+            id_vector.push_back(i);
+        size_t root_page_id = buildIdTree(9, id_vector);
+        std::vector<char> key(kSizeOfBool + kSizeOfSizeT);
+        serializeRowKey(1500, key.data());
+        size_t leaf_page_id = BPlusTreeSearch(root_page_id, key.data(), false).page_ptr->page_id;
+        size_t left_page_id = getPageHandle(leaf_page_id)->header.left_page_id;
+        expect(BPlusTreeHintSearch(leaf_page_id, 9, key.data()), "hint finds the row in its leaf");
+        expect(BPlusTreeHintSearch(left_page_id, 9, key.data()), "hint follows a split to the right");
+        expect(!BPlusTreeHintSearch(leaf_page_id, 10, key.data()), "hint to a page of another tree misses");
+        expect(!BPlusTreeHintSearch(root_page_id, 9, key.data()), "hint to an internal page misses");
+        BPlusTreeRemove(root_page_id);
+        expect(!BPlusTreeHintSearch(leaf_page_id, 9, key.data()), "hint to a freed page misses");
+        query("CREATE TABLE t(id INT, val CHAR(200));");
+        query("CREATE INDEX i ON t(val);");
+        insertRows("t", 0, 2000, "h");
+        query("DELETE FROM t WHERE id >= 500 AND id < 1500;");
+        insertRows("t", 3000, 4000, "h");
+        auto rows = query("SELECT id FROM t WHERE val = 'h1700';");
+        expect(rows.size() == 1 && rows.front().front() == "1700", "index lookup finds a row whose page hint went stale");
+        expect(query("SELECT id FROM t WHERE val = 'h700';").empty(), "index lookup misses a deleted row");
+    }
+    // A CLUSTERED table keeps its rows in primary key order, so a scan comes
+    // back sorted and a key range reads only the rows inside it.
+    void clusteredTest()
+    {
+        query("CREATE DATABASE clustered_table PAGE_SIZE = 4096;");
+        query("USE clustered_table;");
+        query("CREATE TABLE c(id INT, val CHAR(200), PRIMARY KEY(id)) CLUSTERED;");
+        for (size_t i = 0; i < 2000; i += 50)
+        {
+            std::string sql = "INSERT INTO c VALUES";
+            for (size_t j = i; j < i + 50; ++j)
+            {
+                long id = static_cast<long>(j * 7919 % 2000) - 1000;
+                sql += std::string(j == i ? "" : ",") + "(" + std::to_string(id) + ",'c" + std::to_string(id) + "')";
+            }
+            query(sql + ";");
+        }
+        auto rows = query("SELECT id FROM c;");
+        bool ordered = rows.size() == 2000;
+        for (size_t i = 0; ordered && i < rows.size(); ++i)
+            ordered = std::stol(rows[i].front()) == static_cast<long>(i) - 1000;
+        expect(ordered, "clustered table scans in primary key order");
+        rows = query("SELECT id, val FROM c WHERE id >= -10 AND id < 10;");
+        ordered = rows.size() == 20;
+        for (size_t i = 0; ordered && i < rows.size(); ++i)
+            ordered = std::stol(rows[i].front()) == static_cast<long>(i) - 10 && rows[i].back() == "c" + rows[i].front();
+        expect(ordered, "primary key range reads the rows inside it in order");
+        expect(query("INSERT INTO c VALUES(5,'again');").front().front() == "error", "clustered table rejects a duplicate primary key");
+        query("DELETE FROM c WHERE id >= 0;");
+        rows = query("SELECT id FROM c WHERE id >= -1000;");
+        expect(rows.size() == 1000 && rows.back().front() == "-1", "delete by primary key range removes its rows");
+    }
+    // Encoded keys compare with memcmp in value order: NULL first, then INTs
+    // across the sign boundary, and CHARs as their zero-padded bytes.
+    void keyEncodingTest()
+    {
+        std::vector<Token> token_vector{Token(kNull), Token(kNum, "", LONG_MIN), Token(kNum, "", -1000), Token(kNum, "", -1), Token(kNum, "", 0), Token(kNum, "", 1), Token(kNum, "", 255), Token(kNum, "", 256), Token(kNum, "", LONG_MAX)};
+        std::vector<std::vector<char>> key_vector;
+        for (auto &&token : token_vector)
+        {
+            key_vector.emplace_back(kSizeOfBool + kSizeOfLong);
+            serializeKey(token, kSizeOfLong, key_vector.back().data());
+        }
+        bool ordered = true;
+        for (size_t i = 1; i < key_vector.size(); ++i)
+            ordered = ordered && std::memcmp(key_vector[i - 1].data(), key_vector[i].data(), kSizeOfBool + kSizeOfLong) < 0;
+        expect(ordered, "INT keys compare in value order with NULL first");
+        token_vector = {Token(kNull), Token(kString, ""), Token(kString, "a"), Token(kString, "ab"), Token(kString, "b"), Token(kString, "ba")};
+        key_vector.clear();
+        for (auto &&token : token_vector)
+        {
+            key_vector.emplace_back(kSizeOfBool + 4);
+            serializeKey(token, 4, key_vector.back().data());
+        }
+        ordered = true;
+        for (size_t i = 1; i < key_vector.size(); ++i)
+            ordered = ordered && std::memcmp(key_vector[i - 1].data(), key_vector[i].data(), kSizeOfBool + 4) < 0;
+        expect(ordered, "CHAR keys compare in byte order with NULL first");
+        std::vector<char> id_key(kSizeOfSizeT);
+        serializeId(123456789, id_key.data());
+        expect(deserializeId(id_key.data()) == 123456789, "row id round trips through its key");
+        query("CREATE DATABASE key_encoding PAGE_SIZE = 4096;");
+        query("USE key_encoding;");
+        query("CREATE TABLE t(id INT, num INT);");
+        query("CREATE INDEX i ON t(num);");
+        query("INSERT INTO t VALUES(1,-5),(2,3),(3,NULL),(4,-300),(5,0),(6,NULL),(7,300),(8,-1);");
+        auto rows = query("SELECT num FROM t WHERE num < 1;");
+        std::vector<std::string> num_vector;
+        for (auto &&row : rows)
+            num_vector.push_back(row.front());
+        std::sort(num_vector.begin(), num_vector.end());
+        expect(num_vector == std::vector<std::string>{"-1", "-300", "-5", "0"}, "index range over negatives skips NULL");
+        expect(query("SELECT id FROM t WHERE num >= -5 AND num <= 3;").size() == 4, "index range crosses zero");
+    }
+    // Range lookups through INT and CHAR indexes, which search their pages
+    // with kernels picked by key type, find the same rows as a brute force
+    // filter over the values inserted.
+    void indexRangeTest()
+    {
+        query("CREATE DATABASE index_range PAGE_SIZE = 4096;");
+        query("USE index_range;");
+        query("CREATE TABLE t(id INT, num INT, name CHAR(12));");
+        query("CREATE INDEX n ON t(num);");
+        query("CREATE INDEX s ON t(name);");
+        std::vector<long> num_vector;
+        std::vector<std::string> name_vector;
+        for (size_t i = 0; i < 3000; i += 50)
+        {
+            std::string sql = "INSERT INTO t VALUES";
+            for (size_t j = i; j < i + 50; ++j)
+            {
+                num_vector.push_back(static_cast<long>(j * 7919 % 1001) - 500);
+                name_vector.push_back("k" + std::to_string(j * 104729 % 3001));
+                sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + "," + std::to_string(num_vector.back()) + ",'" + name_vector.back() + "')";
+            }
+            query(sql + ";");
+        }
+        bool match = true;
+        for (long low : {-600L, -500L, -17L, 0L, 499L})
+        {
+            for (long high : {-400L, -1L, 0L, 250L, 600L})
+            {
+                std::vector<std::string> expected_vector, id_vector;
+                for (size_t i = 0; i < num_vector.size(); ++i)
+                {
+                    if (num_vector[i] >= low && num_vector[i] <= high)
+                        expected_vector.push_back(std::to_string(i));
+                }
+                for (auto &&row : query("SELECT id FROM t WHERE num >= " + std::to_string(low) + " AND num <= " + std::to_string(high) + ";"))
+                    id_vector.push_back(row.front());
+                std::sort(expected_vector.begin(), expected_vector.end());
+                std::sort(id_vector.begin(), id_vector.end());
+                match = match && id_vector == expected_vector;
+            }
+        }
+        expect(match, "INT index ranges match a brute force filter");
+        match = true;
+        for (const std::string &low : {"k1", "k15", "k2999", "k5"})
+        {
+            for (const std::string &high : {"k1", "k2", "k3000", "k9"})
+            {
+                std::vector<std::string> expected_vector, id_vector;
+                for (size_t i = 0; i < name_vector.size(); ++i)
+                {
+                    if (name_vector[i] >= low && name_vector[i] < high)
+                        expected_vector.push_back(std::to_string(i));
+                }
+                for (auto &&row : query("SELECT id FROM t WHERE name >= '" + low + "' AND name < '" + high + "';"))
+                    id_vector.push_back(row.front());
+                std::sort(expected_vector.begin(), expected_vector.end());
+                std::sort(id_vector.begin(), id_vector.end());
+                match = match && id_vector == expected_vector;
+            }
+        }
+        expect(match, "CHAR index ranges match a brute force filter");
+        auto rows = query("SELECT id FROM t WHERE name = 'k104';");
+        expect(rows.size() == 1 && name_vector[std::stol(rows.front().front())] == "k104", "CHAR index finds an equal key");
+    }
+    // Whichever kernel the CPU gets, countWordsBelow counts the same entries
+    // as a plain loop, words with the high bit set and misaligned steps too.
+    void simdSearchTest()
+    {
+        const size_t kWordCount = 40;
+        std::vector<uint64_t> word_vector;
+        for (size_t i = 0; i < kWordCount; ++i)
+            word_vector.push_back(i < kWordCount / 2 ? i * 3 : (static_cast<uint64_t>(1) << 63) + i * 3);
+        bool match = true;
+        for (size_t step : {8, 9, 17})
+        {
+            std::vector<char> buffer(step * kWordCount + 1);
+            for (size_t i = 0; i < kWordCount; ++i)
+            {
+                for (size_t j = 0; j < 8; ++j)
+                    buffer[1 + i * step + j] = static_cast<char>(word_vector[i] >> ((7 - j) * 8));
+            }
+            for (size_t count = 0; count <= kWordCount; ++count)
+            {
+                for (size_t i = 0; i < kWordCount; ++i)
+                {
+                    for (uint64_t key : {word_vector[i] - 1, word_vector[i], word_vector[i] + 1})
+                    {
+                        for (bool inclusive : {false, true})
+                        {
+                            size_t expected = 0;
+                            while (expected < count && (word_vector[expected] < key || (inclusive && word_vector[expected] == key)))
+                                ++expected;
+                            match = match && countWordsBelow(buffer.data() + 1, step, count, key, inclusive) == expected;
+                        }
+                    }
+                }
+            }
+        }
+        expect(match, "page search kernel counts like a plain loop");
+    }
+    // CHAR index pages store the prefix their keys share once, and splits cut
+    // separators to the bytes that tell the halves apart; lookups through an
+    // index of keys with a long common prefix stay exact through splits and
+    // deletes.
+    void prefixCompressionTest()
+    {
+        query("CREATE DATABASE prefix_compression PAGE_SIZE = 4096;");
+        query("USE prefix_compression;");
+        query("CREATE TABLE t(id INT, name CHAR(100));");
+        query("CREATE INDEX n ON t(name);");
+        const std::string prefix = "customer/region-north/account/000000000000000000000000000000/";
+        for (size_t i = 0; i < 3000; i += 50)
+        {
+            std::string sql = "INSERT INTO t VALUES";
+            for (size_t j = i; j < i + 50; ++j)
+                sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + ",'" + prefix + std::to_string(10000 + j * 7919 % 3000) + "')";
+            query(sql + ";");
+        }
+        bool match = true;
+        for (size_t i = 0; i < 3000; i += 97)
+        {
+            auto rows = query("SELECT id FROM t WHERE name = '" + prefix + std::to_string(10000 + i) + "';");
+            match = match && rows.size() == 1 && std::stol(rows.front().front()) * 7919 % 3000 == i;
+        }
+        expect(match, "index with a long common prefix finds every key");
+        expect(query("SELECT id FROM t WHERE name >= '" + prefix + "11000' AND name < '" + prefix + "11500';").size() == 500, "range over a long common prefix");
+        expect(query("SELECT id FROM t WHERE name = '" + prefix.substr(0, prefix.size() - 1) + "';").empty(), "key that is a prefix of the others misses");
+        query("DELETE FROM t WHERE name >= '" + prefix + "10000' AND name < '" + prefix + "11000';");
+        expect(query("SELECT id FROM t WHERE name >= '" + prefix + "';").size() == 2000, "delete over a long common prefix");
+        expect(query("SELECT id FROM t WHERE name = '" + prefix + "12345';").size() == 1, "lookup after deletes merged pages");
+    }
+    // VARCHAR values take their own length in slotted leaves instead of the
+    // declared width, read back byte for byte and make room for each other
+    // as rows are deleted and inserted again.
+    void varcharTest()
+    {
+        size_t file_size = 0;
+        for (const std::string &data_type : {"CHAR(255)", "VARCHAR(255)"})
+        {
+            std::string database_name = data_type == "CHAR(255)" ? "fixed_width" : "variable_width";
+            query("CREATE DATABASE " + database_name + " PAGE_SIZE = 4096;");
+            query("USE " + database_name + ";");
+            query("CREATE TABLE t(id INT, val " + data_type + ");");
+            insertRows("t", 0, 2000, "v");
+            if (data_type == "CHAR(255)")
+                file_size = FileSystem::getInstance().size();
+        }
+        expect(FileSystem::getInstance().size() * 4 < file_size, "short VARCHAR values take far less room than CHAR");
+        std::vector<std::string> value_vector{"", "x", std::string(100, 'm'), std::string(254, 'y'), std::string(255, 'z')};
+        std::string sql = "INSERT INTO t VALUES";
+        for (size_t i = 0; i < value_vector.size(); ++i)
+            sql += std::string(i == 0 ? "" : ",") + "(" + std::to_string(5000 + i) + ",'" + value_vector[i] + "')";
+        query(sql + ";");
+        bool match = true;
+        for (size_t i = 0; i < value_vector.size(); ++i)
+        {
+            auto rows = query("SELECT val FROM t WHERE id = " + std::to_string(5000 + i) + ";");
+            match = match && rows.size() == 1 && rows.front().front() == value_vector[i];
+        }
+        expect(match, "VARCHAR values of every length read back");
+        query("INSERT INTO t VALUES(6000,'" + std::string(300, 'o') + "');");
+        auto rows = query("SELECT val FROM t WHERE id = 6000;");
+        expect(rows.size() == 1 && rows.front().front() == std::string(255, 'o'), "VARCHAR value longer than declared is cut like CHAR");
+        size_t grown_size = FileSystem::getInstance().size();
+        query("DELETE FROM t WHERE id >= 0 AND id < 1000;");
+        for (size_t i = 0; i < 1000; i += 50)
+        {
+            sql = "INSERT INTO t VALUES";
+            for (size_t j = i; j < i + 50; ++j)
+                sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + ",'" + std::string(j % 4, 'r') + "')";
+            query(sql + ";");
+        }
+        expect(FileSystem::getInstance().size() <= grown_size + grown_size / 4, "deleted VARCHAR rows make room for new ones");
+        rows = query("SELECT val FROM t WHERE id >= 0 AND id < 1000;");
+        match = rows.size() == 1000;
+        for (auto &&row : rows)
+            match = match && row.front().find_first_not_of('r') == std::string::npos;
+        expect(match, "rows inserted again over deleted ones read back");
+    }
+    // A value too long for its leaf moves to a chain of overflow pages. The
+    // row reads back whole, and deleting it hands the chain back so a row
+    // of the same length inserted again does not grow the file.
+    void overflowTest()
+    {
+        query("CREATE DATABASE overflow PAGE_SIZE = 4096;");
+        query("USE overflow;");
+        query("CREATE TABLE t(id INT, body VARCHAR(20000), note VARCHAR(100));");
+        std::vector<std::string> body_vector;
+        for (size_t i = 0; i < 20; ++i)
+        {
+            body_vector.push_back("b" + std::to_string(i) + std::string(i * 997 % 20000, static_cast<char>('a' + i)));
+            body_vector.back().resize(std::min<size_t>(body_vector.back().size(), 20000));
+            query("INSERT INTO t VALUES(" + std::to_string(i) + ",'" + body_vector.back() + "','n" + std::to_string(i) + "');");
+        }
+        bool match = true;
+        for (size_t i = 0; i < body_vector.size(); ++i)
+        {
+            auto rows = query("SELECT body, note FROM t WHERE id = " + std::to_string(i) + ";");
+            match = match && rows.size() == 1 && rows.front().front() == body_vector[i] && rows.front().back() == "n" + std::to_string(i);
+        }
+        expect(match, "rows with overflowing values read back whole");
+        size_t file_size = FileSystem::getInstance().size();
+        for (size_t round = 0; round < 3; ++round)
+        {
+            query("DELETE FROM t WHERE id >= 10;");
+            for (size_t i = 10; i < body_vector.size(); ++i)
+                query("INSERT INTO t VALUES(" + std::to_string(i) + ",'" + body_vector[i] + "','n" + std::to_string(i) + "');");
+        }
+        expect(FileSystem::getInstance().size() <= file_size + file_size / 10, "deleted rows hand their overflow pages back");
+        auto rows = query("SELECT body FROM t WHERE id = 19;");
+        expect(rows.size() == 1 && rows.front().front() == body_vector[19], "row inserted over freed overflow pages reads back");
+        query("TRUNCATE TABLE t;");
+        query("INSERT INTO t VALUES(1,'" + body_vector[19] + "','n1');");
+        expect(FileSystem::getInstance().size() <= file_size + file_size / 10, "truncate hands overflow pages back");
+    }
+    // Rows keep NULLs in a bitmap and store fixed-width columns aligned in
+    // an order of their own; neither shows through what a SELECT returns.
+    void rowFormatTest()
+    {
+        query("CREATE DATABASE row_format PAGE_SIZE = 4096;");
+        query("USE row_format;");
+        query("CREATE TABLE t(c0 CHAR(3), c1 INT, c2 CHAR(5), c3 INT, c4 VARCHAR(20), c5 INT, c6 CHAR(2), c7 INT, c8 CHAR(7), c9 INT);");
+        std::vector<std::vector<std::string>> expected_vector;
+        for (size_t i = 0; i < 40; ++i)
+        {
+            std::vector<std::string> row;
+            std::string values;
+            for (size_t j = 0; j < 10; ++j)
+            {
+                bool null = (i >> (j % 6)) & 1 && (i + j) % 3 == 0;
+                std::string value = j % 2 == 1 ? std::to_string(static_cast<long>(i * 1000 + j) - 20000) : std::string(1, static_cast<char>('a' + j)) + std::to_string(i % 10);
+                row.push_back(null ? "NULL" : value);
+                values += std::string(j == 0 ? "" : ",") + (null ? "NULL" : j % 2 == 1 ? value : "'" + value + "'");
+            }
+            expected_vector.push_back(row);
+            query("INSERT INTO t VALUES(" + values + ");");
+        }
+        expect(query("SELECT * FROM t;") == expected_vector, "rows read back with their NULLs in column order");
+        auto rows = query("SELECT c9, c0, c5 FROM t;");
+        bool match = rows.size() == expected_vector.size();
+        for (size_t i = 0; match && i < rows.size(); ++i)
+            match = rows[i] == std::vector<std::string>{expected_vector[i][9], expected_vector[i][0], expected_vector[i][5]};
+        expect(match, "columns picked out of order read back");
+        expect(query("SELECT c1 FROM t WHERE c3 = -16997;").size() == 1, "filter reads an aligned column");
+    }
+    // Every page header field holds the largest value a page can need, -1
+    // included for the 32 bit ones, without touching its neighbours.
+    void pageHeaderTest()
+    {
+        std::vector<char> buffer(kOffsetOfPageHeader + 1, '\x5a');
+        std::vector<std::pair<size_t, size_t>> field_vector{{kOffsetOfSize, kMaxPageSize}, {kOffsetOfLeftPageId, -1}, {kOffsetOfRightPageId, UINT32_MAX - 1}, {kOffsetOfTreeId, 123456}, {kOffsetOfHeapSize, kMaxPageSize}, {kOffsetOfKeySize, UINT16_MAX}, {kOffsetOfIndexSize, 1}, {kOffsetOfValueSize, kMaxPageSize - 1}, {kOffsetOfPrefixSize, 0}, {kOffsetOfLeaf, 1}};
+        for (auto &&field : field_vector)
+            writeHeaderField(buffer.data(), field.first, field.second);
+        bool match = buffer.back() == '\x5a';
+        for (auto &&field : field_vector)
+            match = match && readHeaderField(buffer.data(), field.first) == field.second;
+        expect(match, "page header fields read back what was written");
+        expect(kOffsetOfPageHeader <= 32 && kOffsetOfPageHeader % 8 == 0, "page header is small and entries start aligned");
+        query("CREATE DATABASE page_header PAGE_SIZE = 4096;");
+        query("USE page_header;");
+        size_t root_page_id = createNewPage(PageSchema(true, 0, -1, -1, 9, 9, 8, 11));
+        Page *page = getPageHandle(root_page_id);
+        expect(readHeaderField(page->buffer, kOffsetOfLeftPageId) == -1 && readHeaderField(page->buffer, kOffsetOfRightPageId) == -1 && readHeaderField(page->buffer, kOffsetOfTreeId) == 11 && readHeaderField(page->buffer, kOffsetOfKeySize) == 9, "new page writes its schema to the header");
+        BPlusTreeRemove(root_page_id);
+    }
+    // Filters on a DICTIONARY column compare its values, not their codes, so
+    // they match what the same filters find in a plain CHAR column.
+    void dictionaryTest()
+    {
+        query("CREATE DATABASE dictionary PAGE_SIZE = 4096;");
+        query("USE dictionary;");
+        query("CREATE TABLE plain(id INT, color CHAR(16));");
+        query("CREATE TABLE coded(id INT, color CHAR(16) DICTIONARY);");
+        const std::vector<std::string> color_vector{"red", "green", "blue", "amber", "violet", "NULL", "teal", "bluegreen"};
+        for (auto &&table_name : {"plain", "coded"})
+        {
+            for (size_t i = 0; i < 1000; i += 50)
+            {
+                std::string sql = "INSERT INTO " + std::string(table_name) + " VALUES";
+                for (size_t j = i; j < i + 50; ++j)
+                {
+                    const std::string &color = color_vector[j * 7 % color_vector.size()];
+                    sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + "," + (color == "NULL" ? color : "'" + color + "'") + ")";
+                }
+                query(sql + ";");
+            }
+        }
+        bool match = true;
+        for (const std::string &condition : {"color = 'blue'", "color != 'blue'", "color < 'blue'", "color >= 'blue' AND color <= 'red'", "color > 'bluegreen'", "color = 'black'", "color = 'blu'"})
+        {
+            auto plain_rows = query("SELECT id, color FROM plain WHERE " + condition + ";");
+            auto coded_rows = query("SELECT id, color FROM coded WHERE " + condition + ";");
+            match = match && plain_rows == coded_rows;
+        }
+        expect(query("SELECT id FROM coded WHERE color = 'blue';").size() == 125, "DICTIONARY column finds a value by equality");
+        expect(match, "DICTIONARY filters match a plain column");
+        expect(query("SELECT id FROM plain;") == query("SELECT id FROM coded;"), "DICTIONARY column keeps every row");
+        query("CREATE TABLE strict(id INT, color CHAR(16) DICTIONARY NOT NULL, PRIMARY KEY(id));");
+        query("INSERT INTO strict VALUES(1,'red');");
+        expect(query("INSERT INTO strict VALUES(1,'cyan');").front().front() == "error", "duplicate key is rejected before coding its value");
+        query("INSERT INTO strict VALUES(2,'cyan');");
+        auto rows = query("SELECT id, color FROM strict;");
+        expect(rows == std::vector<std::vector<std::string>>{{"1", "red"}, {"2", "cyan"}}, "value of a rejected row is coded when a later row brings it");
+    }
+    // The page codec gives back exactly what it was given, refuses output
+    // that does not decode to the whole block, and its checksum notices a
+    // flipped bit. Pages of a COMPRESSED table with pages large enough to
+    // save a block go to disk through it and read back the same from a cold
+    // pool.
+    void pageCodecTest()
+    {
+        std::vector<std::vector<char>> block_vector{std::vector<char>(4096, '\0'), std::vector<char>(65536, 'z'), std::vector<char>(17)};
+        std::string text;
+        while (text.size() < 4096)
+            text += "row " + std::to_string(text.size() % 97) + " of a table with repeated text; ";
+        block_vector.emplace_back(text.begin(), text.begin() + 4096);
+        std::vector<char> noise(4096);
+        uint64_t state = 88172645463325252ULL;
+        for (auto &&byte : noise)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            byte = static_cast<char>(state);
+        }
+        block_vector.push_back(noise);
+        bool match = true;
+        for (auto &&block : block_vector)
+        {
+            std::vector<char> compressed(block.size() * 2 + 64), decompressed(block.size());
+            size_t size = compressBlock(block.data(), block.size(), compressed.data(), compressed.size());
+            match = match && size != 0 && decompressBlock(compressed.data(), size, decompressed.data(), decompressed.size()) && decompressed == block;
+            match = match && !decompressBlock(compressed.data(), size / 2, decompressed.data(), decompressed.size());
+        }
+        expect(match, "codec round trips blocks and rejects cut ones");
+        std::vector<char> compressed(4096);
+        expect(compressBlock(noise.data(), noise.size(), compressed.data(), 1024) == 0, "codec gives up when the output does not fit");
+        uint32_t checksum = blockChecksum(text.data(), 4096);
+        text[1234] ^= 0x10;
+        expect(blockChecksum(text.data(), 4096) != checksum, "checksum notices a flipped bit");
+        query("CREATE DATABASE page_codec PAGE_SIZE = 16384;");
+        query("USE page_codec;");
+        query("CREATE TABLE archive(id INT, val CHAR(200), PRIMARY KEY(id)) CLUSTERED COMPRESSED;");
+        FileSystem &file_system = FileSystem::getInstance();
+        size_t compressed_write_count = file_system.compressedWriteCount();
+        insertRows("archive", 0, 2000, "archived row ");
+        expect(file_system.compressedWriteCount() > compressed_write_count, "COMPRESSED table writes compressed pages");
+        BufferPool::getInstance().clear(file_system.getFileId());
+        auto rows = query("SELECT id, val FROM archive;");
+        match = rows.size() == 2000;
+        for (size_t i = 0; match && i < rows.size(); ++i)
+            match = rows[i] == std::vector<std::string>{std::to_string(i), "archived row " + std::to_string(i)};
+        expect(match, "COMPRESSED table reads back from disk");
+    }
+    // A COLUMNAR table answers like a row table holding the same rows, and a
+    // query over a few of its columns reads only their pages.
+    void columnarTest()
+    {
+        query("CREATE DATABASE columnar PAGE_SIZE = 4096;");
+        query("USE columnar;");
+        std::string columns = "id INT, ts INT, kind CHAR(16) DICTIONARY";
+        for (size_t i = 0; i < 6; ++i)
+            columns += ", pad" + std::to_string(i) + " CHAR(60)";
+        query("CREATE TABLE plain(" + columns + ", PRIMARY KEY(id));");
+        query("CREATE TABLE wide(" + columns + ", PRIMARY KEY(id)) ENGINE = COLUMNAR;");
+        for (auto &&table_name : {"plain", "wide"})
+        {
+            for (size_t i = 0; i < 2000; i += 50)
+            {
+                std::string sql = "INSERT INTO " + std::string(table_name) + " VALUES";
+                for (size_t j = i; j < i + 50; ++j)
+                {
+                    sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + "," + (j % 17 == 0 ? "NULL" : std::to_string(j * 31 % 1000)) + ",'k" + std::to_string(j % 5) + "'";
+                    for (size_t k = 0; k < 6; ++k)
+                        sql += ",'pad " + std::to_string(k) + " of row " + std::to_string(j) + "'";
+                    sql += ")";
+                }
+                query(sql + ";");
+            }
+        }
+        bool match = true;
+        for (const std::string &select : {"SELECT * FROM $ WHERE id >= 1990;", "SELECT id, ts FROM $ WHERE ts < 100;", "SELECT kind, pad3 FROM $ WHERE kind = 'k2' AND id < 300;", "SELECT id FROM $ WHERE ts = NULL;"})
+        {
+            std::string plain_sql = select, wide_sql = select;
+            plain_sql.replace(plain_sql.find('$'), 1, "plain");
+            wide_sql.replace(wide_sql.find('$'), 1, "wide");
+            match = match && query(plain_sql) == query(wide_sql);
+        }
+        expect(match, "COLUMNAR table answers like a row table");
+        query("DELETE FROM plain WHERE id >= 500 AND id < 1500;");
+        query("DELETE FROM wide WHERE id >= 500 AND id < 1500;");
+        expect(query("SELECT id, ts, pad5 FROM plain;") == query("SELECT id, ts, pad5 FROM wide;"), "COLUMNAR table deletes like a row table");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        FileSystem &file_system = FileSystem::getInstance();
+        std::vector<size_t> read_count_vector;
+        for (auto &&table_name : {"plain", "wide"})
+        {
+            buffer_pool.clear(file_system.getFileId());
+            size_t read_count = file_system.readCount();
+            query("SELECT ts FROM " + std::string(table_name) + " WHERE ts > 500;");
+            read_count_vector.push_back(file_system.readCount() - read_count);
+        }
+        expect(read_count_vector.back() * 4 < read_count_vector.front(), "COLUMNAR scan of one column reads only its pages");
+    }
+    // A scan filtered on a ZONEMAP column skips the leaves whose range rules
+    // the filter out, finds what a plain scan finds, and keeps finding it as
+    // rows are deleted and inserted out of order.
+    void zoneMapTest()
+    {
+        query("CREATE DATABASE zone_map PAGE_SIZE = 4096;");
+        query("USE zone_map;");
+        query("CREATE TABLE plain(id INT, ts INT, msg CHAR(120));");
+        query("CREATE TABLE zoned(id INT, ts INT ZONEMAP, msg CHAR(120));");
+        for (auto &&table_name : {"plain", "zoned"})
+        {
+            for (size_t i = 0; i < 3000; i += 50)
+            {
+                std::string sql = "INSERT INTO " + std::string(table_name) + " VALUES";
+                for (size_t j = i; j < i + 50; ++j)
+                    sql += std::string(j == i ? "" : ",") + "(" + std::to_string(j) + "," + (j % 101 == 0 ? "NULL" : std::to_string(100000 + j * 10)) + ",'event " + std::to_string(j) + "')";
+                query(sql + ";");
+            }
+        }
+        const std::vector<std::string> condition_vector{"ts > 129000", "ts >= 100000 AND ts < 100500", "ts = 115000", "ts < 0", "ts > 100000 AND id < 10"};
+        auto compare = [&]() {
+            bool match = true;
+            for (auto &&condition : condition_vector)
+                match = match && query("SELECT id, ts, msg FROM plain WHERE " + condition + ";") == query("SELECT id, ts, msg FROM zoned WHERE " + condition + ";");
+            return match;
+        };
+        expect(compare(), "ZONEMAP scan finds what a plain scan finds");
+        BufferPool &buffer_pool = BufferPool::getInstance();
+        FileSystem &file_system = FileSystem::getInstance();
+        std::vector<size_t> read_count_vector;
+        for (auto &&table_name : {"plain", "zoned"})
+        {
+            buffer_pool.clear(file_system.getFileId());
+            size_t read_count = file_system.readCount();
+            query("SELECT id FROM " + std::string(table_name) + " WHERE ts > 129000;");
+            read_count_vector.push_back(file_system.readCount() - read_count);
+        }
+        expect(read_count_vector.back() * 4 < read_count_vector.front(), "ZONEMAP scan of the tail reads few pages");
+        for (auto &&table_name : {"plain", "zoned"})
+        {
+            query("DELETE FROM " + std::string(table_name) + " WHERE ts > 129500;");
+            query("INSERT INTO " + std::string(table_name) + " VALUES(5000,50,'early'),(5001,200000,'late'),(5002,115000,'again');");
+        }
+        expect(compare(), "ZONEMAP scan stays right after deletes and inserts");
+    }
+};
+} // namespace unittest
+
+#endif
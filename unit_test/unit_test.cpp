@@ -1,4 +1,5 @@
 #include "unit_test.h"
+#include "behavior_test.h"
 
 int main()
 {
@@ -6,5 +7,31 @@ int main()
     //test.shellTest();
    // test.lexerTest();
     test.parserTest();
-    return 0;
+    unittest::BehaviorTest behavior_test;
+    behavior_test.rangeDeleteTest();
+    behavior_test.scanResistanceTest();
+    behavior_test.pinTest();
+    behavior_test.headerCacheTest();
+    behavior_test.bufferPoolSizeTest();
+    behavior_test.sharedPoolTest();
+    behavior_test.warmupTest();
+    behavior_test.mmapTest();
+    behavior_test.pageSizeTest();
+    behavior_test.readAheadTest();
+    behavior_test.multiSearchTest();
+    behavior_test.rowHintTest();
+    behavior_test.clusteredTest();
+    behavior_test.keyEncodingTest();
+    behavior_test.indexRangeTest();
+    behavior_test.simdSearchTest();
+    behavior_test.prefixCompressionTest();
+    behavior_test.varcharTest();
+    behavior_test.overflowTest();
+    behavior_test.rowFormatTest();
+    behavior_test.pageHeaderTest();
+    behavior_test.dictionaryTest();
+    behavior_test.pageCodecTest();
+    behavior_test.columnarTest();
+    behavior_test.zoneMapTest();
+    return behavior_test.failureCount() != 0;
 }
\ No newline at end of file